@@ -3,17 +3,36 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoord;
 
+// Per-frame data, written once per frame by Renderer::beginFrame
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+
+// Per-object data; normalMatrix is computed once per object on the CPU
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix;
+
+// Mesh dequantization (scale = 1, offset = 0 for float vertex data)
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    vec3 position = aPos * positionScale + positionOffset;
+    FragPos = vec3(model * vec4(position, 1.0));
+#ifdef PER_VERTEX_NORMAL_MATRIX
+    // Previous behaviour (a 4x4 inverse per vertex), kept for -benchvs
     Normal = mat3(transpose(inverse(model))) * aNormal;
+#else
+    Normal = normalMatrix * aNormal;
+#endif
     TexCoord = aTexCoord;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
@@ -0,0 +1,39 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+
+// Per-instance data from the instance buffer (divisor 1)
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in mat3 instanceNormalMatrix;
+
+// Per-frame data, written once per frame by Renderer::beginFrame
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 viewPos;
+};
+
+// Mesh dequantization (scale = 1, offset = 0 for float vertex data)
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+
+void main() {
+    vec3 position = aPos * positionScale + positionOffset;
+    FragPos = vec3(instanceModel * vec4(position, 1.0));
+#ifdef PER_VERTEX_NORMAL_MATRIX
+    // A 4x4 inverse per vertex, only for the -benchvs comparison
+    Normal = mat3(transpose(inverse(instanceModel))) * aNormal;
+#else
+    Normal = instanceNormalMatrix * aNormal;
+#endif
+    TexCoord = aTexCoord;
+    
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,312 @@
+// Microbenchmarks for the OptimizedMotionController hot paths. Needs only GLM,
+// so it builds and runs on machines without GL, GLFW or GLEW.
+//
+//   motion_benchmark [--max-keyframes N] [--min-time seconds] [--filter text] [--json file]
+
+#include "motion/MotionController.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Reaches the private members the benchmarks time
+class MotionControllerBenchmark
+{
+public:
+    // As getTransformationMatrix uses it: the result becomes the next lookup's hint
+    static int findSegment(const OptimizedMotionController &controller, float time)
+    {
+        int segment = controller.findSegment(time);
+        controller.lastSegment = segment;
+        return segment;
+    }
+
+    static void rebuildSegments(const OptimizedMotionController &controller)
+    {
+        controller.segmentsCached = false;
+        controller.precomputeSegments();
+    }
+
+    static glm::vec3 normalizeAngles(const OptimizedMotionController &controller, const glm::vec3 &angles,
+                                     const glm::vec3 &reference)
+    {
+        return controller.normalizeAngles(angles, reference);
+    }
+};
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+const size_t PATTERN_SIZE = 1 << 16; // Lookup times per access pattern, cycled
+volatile float sink;                 // Keeps results alive
+
+struct Result
+{
+    std::string name;
+    size_t keyframes;
+    double nanosecondsPerOp;
+    uint64_t ops;
+};
+
+struct Options
+{
+    size_t maxKeyframes = 10000000;
+    double minSeconds = 0.2;
+    std::string filter;
+    std::string jsonPath;
+};
+
+// Whole decimal number in [minimum, maximum]; false for anything else
+bool parseCount(const char *text, unsigned long long minimum, unsigned long long maximum, size_t &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || text[0] == '-' || parsed < minimum || parsed > maximum)
+        return false;
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+// Whole finite number in [minimum, maximum]; false for anything else
+bool parseNumber(const char *text, double minimum, double maximum, double &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !std::isfinite(parsed) || parsed < minimum ||
+        parsed > maximum)
+        return false;
+    value = parsed;
+    return true;
+}
+
+// Run body(n) with growing n until one run takes minSeconds; ns per op of that run
+double measure(const std::function<void(uint64_t)> &body, double minSeconds, uint64_t &ops)
+{
+    uint64_t batch = 1;
+    for (;;)
+    {
+        auto start = Clock::now();
+        body(batch);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minSeconds || batch >= (1ull << 40))
+        {
+            ops = batch;
+            return seconds * 1e9 / batch;
+        }
+
+        // Aim just past the target, growing at most 100x per step
+        uint64_t predicted = seconds > 0.0 ? static_cast<uint64_t>(batch * minSeconds * 1.2 / seconds) : batch * 100;
+        batch = std::max(batch * 2, std::min(batch * 100, predicted));
+    }
+}
+
+// Keyframes one second apart on a looping path. The object keeps spinning,
+// so its Euler angles accumulate: keyframe i is turned i * 45 degrees.
+void buildController(OptimizedMotionController &controller, size_t count)
+{
+    std::vector<KeyFrame> keyframes;
+    keyframes.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        float phase = static_cast<float>(i) * 0.1f;
+        glm::vec3 position(std::cos(phase) * 5.0f, std::sin(phase * 0.5f) * 2.0f, std::sin(phase) * 5.0f);
+        glm::vec3 euler(static_cast<float>(i % 8) * 10.0f, static_cast<float>(i) * 45.0f, 0.0f);
+        keyframes.emplace_back(position, euler, static_cast<float>(i));
+    }
+    controller.clearKeyFrames();
+    controller.addMultipleKeyFrames(keyframes);
+}
+
+// Lookup times over [0, total] in the order an access pattern produces them
+std::vector<float> makePattern(const std::string &pattern, float total)
+{
+    std::vector<float> times(PATTERN_SIZE);
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> anywhere(0.0f, total);
+    float step = std::min(1.0f / 60.0f, total / PATTERN_SIZE); // Playback at 60 fps
+
+    if (pattern == "sequential" || pattern == "reverse")
+    {
+        for (size_t i = 0; i < PATTERN_SIZE; i++)
+        {
+            float time = std::fmod(i * step, total);
+            times[i] = pattern == "sequential" ? time : total - time;
+        }
+    }
+    else if (pattern == "random")
+    {
+        for (float &time : times)
+            time = anywhere(random);
+    }
+    else // scrub: dragging a timeline back and forth, with occasional jumps
+    {
+        std::uniform_real_distribution<float> drag(-2.0f, 2.0f);
+        std::uniform_int_distribution<int> jump(0, 19);
+        float time = anywhere(random);
+        for (float &sample : times)
+        {
+            time = jump(random) == 0 ? anywhere(random) : std::clamp(time + drag(random), 0.0f, total);
+            sample = time;
+        }
+    }
+    return times;
+}
+
+void run(std::vector<Result> &results, const Options &options, const std::string &name, size_t keyframes,
+         const std::function<void(uint64_t)> &body)
+{
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+        return;
+
+    Result result;
+    result.name = name;
+    result.keyframes = keyframes;
+    result.nanosecondsPerOp = measure(body, options.minSeconds, result.ops);
+    results.push_back(result);
+
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << keyframes << std::fixed
+              << std::setprecision(2) << std::setw(16) << result.nanosecondsPerOp << std::setw(14) << result.ops
+              << std::endl;
+}
+
+bool writeJson(const std::vector<Result> &results, const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+
+    file << "{\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &result = results[i];
+        file << (i ? ",\n" : "\n") << "    {\"name\": \"" << result.name << "\", \"keyframes\": " << result.keyframes
+             << ", \"nsPerOp\": " << result.nanosecondsPerOp << ", \"ops\": " << result.ops << "}";
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool valid = true;
+        bool badValue = false;
+        if (arg == "--max-keyframes" && i + 1 < argc)
+            badValue = !parseCount(argv[++i], 2, 10000000, options.maxKeyframes);
+        else if (arg == "--min-time" && i + 1 < argc)
+            badValue = !parseNumber(argv[++i], 0.0, 3600.0, options.minSeconds);
+        else if (arg == "--filter" && i + 1 < argc)
+            options.filter = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            options.jsonPath = argv[++i];
+        else
+            valid = false;
+
+        if (badValue)
+            std::cerr << "Invalid value for " << arg << ": " << argv[i] << std::endl;
+        if (!valid || badValue)
+        {
+            std::cout << "Usage: " << argv[0] << " [--max-keyframes N] [--min-time seconds] [--filter text]"
+                      << " [--json file]" << std::endl;
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<size_t> counts = {2, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+    counts.erase(std::remove_if(counts.begin(), counts.end(),
+                                [&options](size_t count) { return count > options.maxKeyframes; }),
+                 counts.end());
+
+    std::cout << std::left << std::setw(40) << "benchmark" << std::right << std::setw(10) << "keyframes"
+              << std::setw(16) << "ns/op" << std::setw(14) << "ops" << std::endl;
+
+    std::vector<Result> results;
+    OptimizedMotionController controller;
+    for (size_t count : counts)
+    {
+        buildController(controller, count);
+        float total = controller.getTotalTime();
+
+        // Segment build cost, per full build (ns per keyframe = ns/op / keyframes)
+        run(results, options, "precomputeSegments", count, [&](uint64_t ops)
+            {
+                for (uint64_t i = 0; i < ops; i++)
+                    MotionControllerBenchmark::rebuildSegments(controller);
+            });
+
+        // Full evaluation during playback, in every orientation/interpolation mode
+        std::vector<float> playback = makePattern("sequential", total);
+        for (int mode = 0; mode < 4; mode++)
+        {
+            bool useQuat = mode < 2;
+            bool useBSpline = mode % 2 == 1;
+            std::string name = std::string("getTransformationMatrix/") + (useQuat ? "quat" : "euler") + "-" +
+                               (useBSpline ? "bspline" : "catmullrom");
+            run(results, options, name, count, [&](uint64_t ops)
+                {
+                    float sum = 0.0f;
+                    for (uint64_t i = 0; i < ops; i++)
+                        sum += controller.getTransformationMatrix(playback[i & (PATTERN_SIZE - 1)], useQuat,
+                                                                  useBSpline)[3][0];
+                    sink = sum;
+                });
+        }
+
+        // Segment lookup alone under different access patterns
+        for (const char *pattern : {"sequential", "reverse", "random", "scrub"})
+        {
+            std::vector<float> times = makePattern(pattern, total);
+            run(results, options, std::string("findSegment/") + pattern, count, [&](uint64_t ops)
+                {
+                    int sum = 0;
+                    for (uint64_t i = 0; i < ops; i++)
+                        sum += MotionControllerBenchmark::findSegment(controller, times[i & (PATTERN_SIZE - 1)]);
+                    sink = static_cast<float>(sum);
+                });
+        }
+
+        // Angle normalization against a zero reference; the largest inputs have
+        // accumulated count * 45 degrees of spin
+        std::vector<glm::vec3> angles(PATTERN_SIZE);
+        std::mt19937 random(54321);
+        std::uniform_real_distribution<float> spin(0.0f, static_cast<float>(count) * 45.0f);
+        for (glm::vec3 &angle : angles)
+            angle = glm::vec3(spin(random), -spin(random), spin(random) * 0.5f);
+        run(results, options, "normalizeAngles/accumulated", count, [&](uint64_t ops)
+            {
+                float sum = 0.0f;
+                for (uint64_t i = 0; i < ops; i++)
+                    sum += MotionControllerBenchmark::normalizeAngles(controller, angles[i & (PATTERN_SIZE - 1)],
+                                                                      glm::vec3(0.0f))
+                               .x;
+                sink = sum;
+            });
+    }
+
+    if (!options.jsonPath.empty())
+    {
+        if (!writeJson(results, options.jsonPath))
+        {
+            std::cerr << "Cannot write " << options.jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "Results written to " << options.jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+// Times the phases of OBJLoader::loadOBJ without a GL context: parse,
+// triangulate and expand, with throughput, peak heap and allocation counts.
+// Inputs come from tools/objgen.
+//
+//   obj_benchmark [--repeat N] <file.obj>...
+
+#include "motion/OBJLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Heap accounting through the global allocation functions. Each block carries
+// its size in a header so frees can be subtracted. The loader is single-threaded.
+namespace
+{
+const size_t HEADER_BYTES = alignof(std::max_align_t);
+
+size_t allocationCount = 0;
+size_t liveBytes = 0;
+size_t peakLiveBytes = 0;
+
+void *countedAllocate(size_t bytes)
+{
+    unsigned char *block = static_cast<unsigned char *>(std::malloc(bytes + HEADER_BYTES));
+    if (!block)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t *>(block) = bytes;
+    allocationCount++;
+    liveBytes += bytes;
+    peakLiveBytes = std::max(peakLiveBytes, liveBytes);
+    return block + HEADER_BYTES;
+}
+
+void countedFree(void *pointer)
+{
+    if (!pointer)
+        return;
+    unsigned char *block = static_cast<unsigned char *>(pointer) - HEADER_BYTES;
+    liveBytes -= *reinterpret_cast<size_t *>(block);
+    std::free(block);
+}
+} // namespace
+
+void *operator new(size_t bytes) { return countedAllocate(bytes); }
+void *operator new[](size_t bytes) { return countedAllocate(bytes); }
+void operator delete(void *pointer) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer) noexcept { countedFree(pointer); }
+void operator delete(void *pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { countedFree(pointer); }
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+struct PhaseResult
+{
+    double milliseconds = 0.0; // Best of the repeats
+    size_t allocations = 0;
+    size_t peakHeapBytes = 0; // Highest live heap during the phase, including earlier phases' data
+};
+
+// Runs one phase and records its cost; allocation counts are the same every repeat
+template <typename Body> void measurePhase(PhaseResult &result, bool first, Body body)
+{
+    size_t allocationsBefore = allocationCount;
+    peakLiveBytes = liveBytes;
+    auto start = Clock::now();
+    body();
+    double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    result.milliseconds = first ? milliseconds : std::min(result.milliseconds, milliseconds);
+    result.allocations = allocationCount - allocationsBefore;
+    result.peakHeapBytes = peakLiveBytes;
+}
+
+size_t fileBytes(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<size_t>(file.tellg()) : 0;
+}
+
+size_t peakRSSBytes()
+{
+#ifndef _WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return static_cast<size_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+    return 0;
+}
+
+void printPhase(const char *name, const PhaseResult &phase, double megabytes, size_t triangles)
+{
+    double seconds = phase.milliseconds / 1000.0;
+    std::cout << "  " << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << phase.milliseconds << std::setw(10) << std::setprecision(1)
+              << (seconds > 0.0 ? megabytes / seconds : 0.0) << std::setw(12) << std::setprecision(2)
+              << (seconds > 0.0 ? triangles / seconds / 1e6 : 0.0) << std::setw(12)
+              << phase.peakHeapBytes / 1048576.0 << std::setw(12) << phase.allocations << std::endl;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int repeat = 3;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc)
+        {
+            char *end = nullptr;
+            long value = std::strtol(argv[++i], &end, 10);
+            if (end == argv[i] || *end != '\0' || value < 1 || value > 1000000)
+            {
+                std::cerr << "Invalid repeat count: " << argv[i] << std::endl;
+                return 1;
+            }
+            repeat = static_cast<int>(value);
+        }
+        else if (!arg.empty() && arg[0] != '-')
+            paths.push_back(arg);
+        else
+        {
+            paths.clear();
+            break;
+        }
+    }
+    if (paths.empty())
+    {
+        std::cout << "Usage: " << argv[0] << " [--repeat N] <file.obj>..." << std::endl;
+        std::cout << "Generate inputs with objgen, e.g. objgen 1000000 tri_v.obj --corners v" << std::endl;
+        return 1;
+    }
+
+    for (const std::string &path : paths)
+    {
+        PhaseResult parse, triangulate, expand;
+        size_t triangles = 0, positions = 0;
+        for (int run = 0; run < repeat; run++)
+        {
+            OBJData obj;
+            std::vector<float> vertices;
+            bool parsed = true;
+            measurePhase(parse, run == 0, [&]() { parsed = OBJLoader::parse(path, obj); });
+            if (!parsed)
+                return 1;
+            measurePhase(triangulate, run == 0, [&]() { OBJLoader::triangulate(obj); });
+            measurePhase(expand, run == 0, [&]() { OBJLoader::expand(obj, vertices); });
+            triangles = obj.triangles.size() / 3;
+            positions = obj.positions.size();
+        }
+
+        PhaseResult total;
+        total.milliseconds = parse.milliseconds + triangulate.milliseconds + expand.milliseconds;
+        total.allocations = parse.allocations + triangulate.allocations + expand.allocations;
+        total.peakHeapBytes = std::max({parse.peakHeapBytes, triangulate.peakHeapBytes, expand.peakHeapBytes});
+
+        double megabytes = fileBytes(path) / 1048576.0;
+        std::cout << path << ": " << std::fixed << std::setprecision(1) << megabytes << " MB, " << positions
+                  << " positions, " << triangles << " triangles (best of " << repeat << ")" << std::endl;
+        std::cout << "  " << std::left << std::setw(12) << "phase" << std::right << std::setw(10) << "ms"
+                  << std::setw(10) << "MB/s" << std::setw(12) << "Mtri/s" << std::setw(12) << "peak MB"
+                  << std::setw(12) << "allocs" << std::endl;
+        printPhase("parse", parse, megabytes, triangles);
+        printPhase("triangulate", triangulate, megabytes, triangles);
+        printPhase("expand", expand, megabytes, triangles);
+        printPhase("total", total, megabytes, triangles);
+    }
+    std::cout << "Peak RSS: " << (peakRSSBytes() >> 20) << " MB" << std::endl;
+    return 0;
+}
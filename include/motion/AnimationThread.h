@@ -0,0 +1,123 @@
+#ifndef ANIMATIONTHREAD_H
+#define ANIMATIONTHREAD_H
+
+#include "MotionController.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Transforms of every animated object at the latest tick and the one before,
+// so the renderer can interpolate between them
+struct TransformSnapshot
+{
+    std::vector<glm::mat4> models;
+    std::vector<glm::mat4> previousModels;
+    bool discontinuity = false; // Animation looped or was reset: do not interpolate
+    float time = 0.0f;
+    uint64_t tick = 0;
+    std::chrono::steady_clock::time_point tickTime; // When models became current
+    std::chrono::steady_clock::duration tickPeriod;
+    std::chrono::steady_clock::time_point published;
+};
+
+// Rigid transforms at the render time now. Rendering runs one tick behind
+// the animation, so now maps to a blend of the last two ticks; translation is
+// interpolated linearly and rotation spherically.
+void interpolateSnapshot(const TransformSnapshot &snapshot, std::chrono::steady_clock::time_point now,
+                         std::vector<glm::mat4> &models);
+
+// Model matrix of instance index out of count: a grid cell, with each
+// instance offset along the animation. A single instance is not moved.
+glm::mat4 instanceTransform(const OptimizedMotionController &controller, size_t index, size_t count, float spacing,
+                            float time, bool useQuaternions, bool useBSpline);
+
+// Evaluates the motion controller on its own thread at a fixed tick rate and
+// hands the results to the render thread through a triple buffer, so a
+// blocking swap never delays animation and a slow animation step never delays
+// a frame. Tick k always shows animation time k * playbackRate / tickRate
+// (since the last reset), independent of frame rate and scheduling jitter;
+// ticks missed by a late wake-up are skipped, not evaluated. While running,
+// the controller must not be used from other threads.
+class AnimationThread
+{
+public:
+    // Counters since the previous collectStats call
+    struct Stats
+    {
+        uint64_t ticks = 0;                // Snapshots published
+        uint64_t skippedTicks = 0;         // Ticks passed over after a late wake-up
+        double evaluateMilliseconds = 0.0; // Average per snapshot
+        double busyFraction = 0.0;         // Share of wall time spent evaluating
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    const OptimizedMotionController *controller;
+    size_t instanceCount;
+    Clock::duration tickPeriod;
+    float tickTimeStep; // Animation seconds per tick
+
+    std::thread thread;
+    std::atomic<bool> running;
+    std::atomic<bool> useQuaternions;
+    std::atomic<bool> useBSpline;
+    std::atomic<float> instanceSpacing;
+    std::atomic<bool> resetRequested;
+
+    TripleBuffer<TransformSnapshot> snapshots;
+
+    // Owned by the animation thread
+    Clock::time_point startTime;
+    uint64_t lastTick;
+    uint64_t resetTick;
+    std::vector<glm::mat4> lastModels;
+
+    // Running totals; collectStats reports the change since its last call
+    std::atomic<uint64_t> tickCount;
+    std::atomic<uint64_t> skippedTickCount;
+    std::atomic<uint64_t> busyNanoseconds;
+    Clock::time_point statsStart;
+    uint64_t statsTicks;
+    uint64_t statsSkippedTicks;
+    uint64_t statsBusyNanoseconds;
+
+    float timeAtTick(uint64_t tick) const;
+    void evaluate(uint64_t tick, std::vector<glm::mat4> &models);
+    void publish(uint64_t tick, bool reset);
+    void run();
+
+public:
+    AnimationThread();
+    ~AnimationThread();
+
+    AnimationThread(const AnimationThread &) = delete;
+    AnimationThread &operator=(const AnimationThread &) = delete;
+
+    // The first snapshot is evaluated before returning, so one is always available.
+    // playbackRate scales animation time against wall time.
+    void start(const OptimizedMotionController *motionController, size_t count, float spacing, double tickRate,
+               float playbackRate);
+    void stop();
+
+    // Settings picked up by the next tick
+    void setInterpolation(bool quaternions, bool bSpline);
+    void setInstanceSpacing(float spacing) { instanceSpacing = spacing; }
+    void resetTime() { resetRequested = true; }
+
+    // Render thread: switch to the newest snapshot; false if none was published
+    // since the last call (the previous snapshot stays current)
+    bool update() { return snapshots.update(); }
+    const TransformSnapshot &getSnapshot() const { return snapshots.readSlot(); }
+
+    Stats collectStats();
+
+    // Totals since construction, for callers that keep their own intervals
+    uint64_t getTickCount() const { return tickCount; }
+    uint64_t getBusyNanoseconds() const { return busyNanoseconds; }
+};
+
+#endif // ANIMATIONTHREAD_H
@@ -0,0 +1,78 @@
+#ifndef ASYNCMESHLOADER_H
+#define ASYNCMESHLOADER_H
+
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "Utils.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Loads a model on a worker thread and streams it into GPU buffers from the
+// render thread, at most frameBudget bytes per frame. update() never blocks:
+// it returns the finished mesh once every byte is resident, nullptr before that.
+class AsyncMeshLoader
+{
+private:
+    static const int STAGING_REGIONS = 3;
+
+    enum class State
+    {
+        Idle,
+        Loading,
+        Uploading,
+        Failed
+    };
+
+    State state;
+    std::string filename;
+    std::chrono::high_resolution_clock::time_point startTime;
+    int uploadFrames;
+
+    // Worker thread output, handed over once workerDone is set. Cached and
+    // streamed models stay in the cache file mapping; parsed ones are in data.
+    std::thread worker;
+    std::atomic<bool> workerDone;
+    bool workerSucceeded;
+    MeshData data;
+    MappedMeshData mapped;
+
+    // Render thread upload progress
+    size_t frameBudget;
+    Mesh *pendingMesh;
+    const unsigned char *vertexSource;
+    const unsigned char *indexSource;
+    size_t vertexBytes;
+    size_t indexBytes;
+    size_t vertexBytesUploaded;
+    size_t indexBytesUploaded;
+
+    // Persistently mapped staging ring (ARB_buffer_storage), one fenced
+    // region per frame in flight. Without the extension chunks go through
+    // glBufferSubData instead.
+    unsigned int stagingBuffer;
+    unsigned char *stagingMemory;
+    GLsync stagingFences[STAGING_REGIONS];
+    int stagingRegion;
+
+    void createStagingBuffer();
+    void destroyStagingBuffer();
+    bool uploadNextChunks();
+    void releaseSources();
+
+public:
+    explicit AsyncMeshLoader(size_t frameBudgetBytes);
+    ~AsyncMeshLoader();
+
+    AsyncMeshLoader(const AsyncMeshLoader &) = delete;
+    AsyncMeshLoader &operator=(const AsyncMeshLoader &) = delete;
+
+    bool start(const std::string &path, const MeshLoadOptions &options);
+    Mesh *update();
+    bool isBusy() const { return state == State::Loading || state == State::Uploading; }
+    // The last model could not be loaded and nothing replaced the placeholder
+    bool hasFailed() const { return state == State::Failed; }
+};
+
+#endif // ASYNCMESHLOADER_H
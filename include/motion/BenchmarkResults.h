@@ -0,0 +1,42 @@
+#ifndef BENCHMARKRESULTS_H
+#define BENCHMARKRESULTS_H
+
+#include "FramePacer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One configuration of the --bench matrix
+struct BenchmarkCase
+{
+    std::string name; // e.g. "quat-catmullrom"
+    FrameTimeHistory::Summary cpuMilliseconds;
+    FrameTimeHistory::Summary gpuMilliseconds;
+    FrameTimeHistory::Summary evaluateMilliseconds; // Transform evaluation per frame
+    double drawCalls = 0.0;                         // Per frame
+    double stateChanges = 0.0;                      // Per frame
+};
+
+struct BenchmarkResults
+{
+    std::string model;
+    std::string keyframes;
+    std::string renderer; // GL_RENDERER of the measuring machine
+    size_t instances = 1;
+    size_t frames = 0;
+    int width = 0;
+    int height = 0;
+    uint64_t peakRSSBytes = 0;
+    std::vector<BenchmarkCase> cases;
+};
+
+// Results as JSON, for regression tracking; baselines are stored in this format
+std::string benchmarkResultsToJson(const BenchmarkResults &results);
+bool writeBenchmarkResults(const BenchmarkResults &results, const std::string &path);
+bool readBenchmarkResults(const std::string &path, BenchmarkResults &results);
+
+// Print every metric next to the baseline. A metric regresses when it is
+// more than threshold (0.1 = 10%) worse; returns the number of regressions.
+int compareBenchmarkResults(const BenchmarkResults &results, const BenchmarkResults &baseline, double threshold);
+
+#endif // BENCHMARKRESULTS_H
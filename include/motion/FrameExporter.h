@@ -0,0 +1,109 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include <GL/glew.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ExportFormat
+{
+    PNG, // Uncompressed (stored deflate) PNG, readable everywhere
+    PPM, // Binary P6
+    Raw  // Headerless RGB24 rows, top to bottom
+};
+
+struct ExportOptions
+{
+    std::string directory = "frames";
+    ExportFormat format = ExportFormat::PNG;
+    std::string pipeCommand; // If set, raw frames go to this process's stdin instead of files
+    int framesInFlight = 3;  // Pixel buffers being read back at once
+    int workerThreads = 0;   // Image writers, 0 = one per spare core
+};
+
+// Reads rendered frames back without stalling the pipeline and writes them
+// out on worker threads. capture() queues an asynchronous glReadPixels into
+// one of framesInFlight pixel buffer objects and fences it; the buffer is
+// mapped and handed to a writer only when it comes round again, by which time
+// the GPU has long finished. Writers flip rows to top-down RGB and write image
+// files in any order; a pipe gets frames in order from a single writer.
+class FrameExporter
+{
+public:
+    struct Stats
+    {
+        uint64_t frames = 0;
+        uint64_t writeErrors = 0;
+        double fenceWaitMilliseconds = 0.0; // Render thread waiting for readbacks
+        double queueWaitMilliseconds = 0.0; // Render thread waiting for writers
+    };
+
+private:
+    struct ReadbackSlot
+    {
+        GLuint buffer = 0;
+        GLsync fence = 0;
+        uint64_t frame = 0;
+    };
+
+    struct Job
+    {
+        uint64_t frame;
+        size_t image; // Index into images
+    };
+
+    ExportOptions options;
+    int width;
+    int height;
+    size_t imageBytes; // RGBA as read back
+
+    std::vector<ReadbackSlot> slots;
+    size_t nextSlot;
+
+    // Worker pool; images cycle between freeImages, jobs and the writers
+    std::vector<std::vector<unsigned char>> images;
+    std::vector<size_t> freeImages;
+    std::deque<Job> jobs;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable imageFreed;
+    bool stopping;
+    FILE *pipe;
+
+    std::atomic<uint64_t> writeErrors;
+    Stats stats;
+
+    void retire(ReadbackSlot &slot);
+    void workerLoop();
+    // rgb and encoded are the writer's scratch buffers
+    bool writeImage(uint64_t frame, const std::vector<unsigned char> &rgba, std::vector<unsigned char> &rgb,
+                    std::vector<unsigned char> &encoded);
+
+public:
+    FrameExporter();
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter &) = delete;
+    FrameExporter &operator=(const FrameExporter &) = delete;
+
+    // Needs a current GL context; frames are width x height from the origin
+    bool start(int frameWidth, int frameHeight, const ExportOptions &exportOptions);
+
+    // Queue a readback of the current read framebuffer (call before the swap)
+    void capture(uint64_t frame);
+
+    // Read back and write everything queued; false if any frame failed to write
+    bool finish();
+
+    const Stats &getStats() const { return stats; }
+};
+
+#endif // FRAMEEXPORTER_H
@@ -0,0 +1,128 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class PacingMode
+{
+    VSync,    // Swap on every vertical blank
+    Adaptive, // VSync, but late frames swap immediately and tear (swap interval -1)
+    Uncapped, // Swap immediately
+    Capped    // Swap immediately, sleep to hold a target frame rate
+};
+
+const char *pacingModeName(PacingMode mode);
+
+// The last CAPACITY samples of one per-frame timing, in milliseconds.
+// Adding a sample is two stores; percentiles are only computed on request.
+class FrameTimeHistory
+{
+public:
+    static const size_t CAPACITY = 1024;
+
+    struct Summary
+    {
+        size_t samples = 0;
+        float p50 = 0.0f;
+        float p95 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+    };
+
+private:
+    float samples[CAPACITY];
+    size_t next;
+    size_t count;
+    mutable std::vector<float> sorted; // Scratch for summarize
+
+public:
+    FrameTimeHistory() : next(0), count(0) {}
+
+    void add(float milliseconds)
+    {
+        samples[next] = milliseconds;
+        next = (next + 1) % CAPACITY;
+        count += count < CAPACITY;
+    }
+
+    Summary summarize() const;
+    void clear() { next = count = 0; }
+
+    // Percentiles of any sample set; sorts values in place
+    static Summary summarize(std::vector<float> &values);
+};
+
+// Sets the swap interval for a pacing mode, holds a frame rate cap by
+// sleeping, and records frame interval, CPU and GPU times per frame with a
+// count of hitches: frames that took much longer than the expected interval.
+// Recording is always on; summaries are computed only when reported.
+class FramePacer
+{
+public:
+    // Uncapped intervals that set the hitch threshold until the first report
+    static const size_t MEDIAN_SEED_FRAMES = 16;
+
+    struct Report
+    {
+        FrameTimeHistory::Summary interval; // Swap to swap
+        FrameTimeHistory::Summary cpu;      // Frame work before the swap
+        FrameTimeHistory::Summary gpu;      // GPU execution, a few frames late
+        uint64_t frames = 0;                // Since the previous report
+        uint64_t hitches = 0;
+        double seconds = 0.0;
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    PacingMode mode;
+    double targetMilliseconds; // Expected frame interval, 0 if unknown
+    Clock::duration capPeriod;
+    Clock::time_point deadline;
+
+    FrameTimeHistory intervals;
+    FrameTimeHistory cpuTimes;
+    FrameTimeHistory gpuTimes;
+    Clock::time_point lastSwap;
+    bool hasLastSwap;
+    float medianInterval; // From the last report, for uncapped hitch detection
+
+    // Until medianInterval is known, uncapped intervals are kept here; their
+    // median becomes the threshold and they are then checked against it
+    float seedIntervals[MEDIAN_SEED_FRAMES];
+    size_t seedCount;
+    void finishSeed(float median);
+
+    uint64_t frameCount;
+    uint64_t hitchCount;
+    Clock::time_point reportStart;
+
+public:
+    FramePacer();
+
+    // Needs a current GL context. Adaptive falls back to VSync where the
+    // driver lacks swap_control_tear. capRate is used by Capped only.
+    void setMode(PacingMode pacingMode, double capRate);
+    PacingMode getMode() const { return mode; }
+
+    // Before starting a frame: sleeps until the frame is due in Capped mode
+    void waitForFrame();
+
+    // After the swap, with the CPU time spent on the frame
+    void endFrame(double cpuMilliseconds);
+    // GPU time of an earlier frame, whenever its results arrive
+    void addGpuTime(double milliseconds) { gpuTimes.add(static_cast<float>(milliseconds)); }
+
+    // Recorded histories, for other views of the same samples
+    const FrameTimeHistory &getIntervals() const { return intervals; }
+    const FrameTimeHistory &getCpuTimes() const { return cpuTimes; }
+    const FrameTimeHistory &getGpuTimes() const { return gpuTimes; }
+
+    // Percentiles over the recorded history; counters restart
+    Report report();
+};
+
+#endif // FRAMEPACER_H
@@ -0,0 +1,91 @@
+#ifndef GLSTATECACHE_H
+#define GLSTATECACHE_H
+
+#include <GL/glew.h>
+#include <cstddef>
+
+// Shadow copy of the GL binding state for the current context. Binds that
+// match the tracked state are dropped; everything else is forwarded to GL and
+// counted. Code that changes tracked state behind the cache's back (or deletes
+// tracked objects) must tell it, otherwise later binds may be skipped wrongly.
+//
+// Tracked: current program, vertex array, GL_ARRAY_BUFFER, indexed uniform
+// buffer ranges, 2D textures per unit and a few enable bits.
+class GLStateCache
+{
+public:
+    static const int MAX_UNIFORM_BINDINGS = 16;
+    static const int MAX_TEXTURE_UNITS = 16;
+
+    struct Stats
+    {
+        size_t drawCalls = 0;
+        size_t stateChanges = 0;     // Calls forwarded to GL
+        size_t redundantChanges = 0; // Calls dropped because nothing changed
+    };
+
+private:
+    static const unsigned int UNKNOWN = ~0u;
+
+    struct BufferRange
+    {
+        unsigned int buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int arrayBuffer;
+    BufferRange uniformRanges[MAX_UNIFORM_BINDINGS];
+    unsigned int activeTextureUnit;
+    unsigned int textures[MAX_TEXTURE_UNITS];
+
+    // Tri-state enable bits: -1 unknown, 0 disabled, 1 enabled
+    int depthTest;
+    int cullFace;
+    int blend;
+
+    Stats frameStats;
+    Stats lastFrameStats;
+
+    int *enableSlot(GLenum capability);
+    bool changed(bool differs)
+    {
+        if (differs)
+            frameStats.stateChanges++;
+        else
+            frameStats.redundantChanges++;
+        return differs;
+    }
+
+public:
+    GLStateCache();
+
+    // The cache for the (single) GL context used by the application
+    static GLStateCache &get();
+
+    void useProgram(unsigned int id);
+    void bindVertexArray(unsigned int id);
+    void bindArrayBuffer(unsigned int id);
+    void bindUniformBufferRange(unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size);
+    void bindTexture2D(unsigned int unit, unsigned int texture);
+    void setEnabled(GLenum capability, bool enabled);
+
+    void countDraw(size_t calls = 1) { frameStats.drawCalls += calls; }
+
+    // Forget tracked objects that are being deleted (GL names get reused)
+    void programDeleted(unsigned int id);
+    void vertexArrayDeleted(unsigned int id);
+    void bufferDeleted(unsigned int id);
+    void textureDeleted(unsigned int id);
+
+    // Mark everything unknown, e.g. after third-party code touched GL state
+    void invalidate();
+
+    // Close the current frame's counters; getFrameStats returns the last closed frame
+    void endFrame();
+    const Stats &getFrameStats() const { return lastFrameStats; }
+};
+
+#endif // GLSTATECACHE_H
@@ -0,0 +1,77 @@
+#ifndef GPURINGBUFFER_H
+#define GPURINGBUFFER_H
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-frame dynamic GPU data in one buffer split into REGIONS frame regions.
+// With ARB_buffer_storage the buffer is persistently and coherently mapped, so
+// callers write straight into GPU-visible memory; each region is fenced when
+// its frame ends and only reused once the GPU has passed that fence. Without
+// the extension allocations are staged in CPU memory and uploaded by unmap().
+class GpuRingBuffer
+{
+public:
+    static const int REGIONS = 3;
+
+private:
+    unsigned int buffer;
+    unsigned char *mappedMemory; // Persistent mapping, or the CPU staging copy
+    std::vector<unsigned char> staging;
+    bool persistent;
+
+    size_t regionSize;
+    size_t alignment;
+    int region;
+    size_t regionUsed;    // Bytes allocated from the current region this frame
+    size_t lastOffset;    // Region-relative offset of the latest allocation
+    size_t lastSize;
+    bool regionAcquired;  // Fence of the current region already waited on
+    GLsync fences[REGIONS];
+
+    // Stall statistics
+    uint64_t frameCount;
+    uint64_t stallCount;
+    double stallMilliseconds;
+
+    bool allocate(size_t size);
+    bool acquireRegion(bool wait);
+
+public:
+    GpuRingBuffer();
+    ~GpuRingBuffer();
+
+    GpuRingBuffer(const GpuRingBuffer &) = delete;
+    GpuRingBuffer &operator=(const GpuRingBuffer &) = delete;
+
+    // The buffer can be bound to any target. alignment applies to every
+    // allocation, e.g. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniform blocks.
+    bool create(size_t regionBytes, size_t allocationAlignment = 16);
+    void destroy();
+
+    // Allocate bytes from this frame's region and return a write pointer.
+    // The first allocation of a frame waits for the region's fence (counted as
+    // a stall if the GPU is still reading it); with wait = false it returns
+    // nullptr instead. A full region grows the buffer.
+    void *map(size_t bytes, bool wait = true);
+
+    // Publish the latest allocation (uploads the staged copy without persistent mapping)
+    void unmap();
+
+    // Fence everything allocated this frame and move to the next region
+    void endFrame();
+
+    unsigned int getBuffer() const { return buffer; }
+    // Buffer offset of the latest allocation, for glBindBufferRange or attribute pointers
+    size_t getOffset() const { return region * regionSize + lastOffset; }
+    size_t getRegionSize() const { return regionSize; }
+    bool isPersistent() const { return persistent; }
+
+    uint64_t getFrameCount() const { return frameCount; }
+    uint64_t getStallCount() const { return stallCount; }
+    double getStallMilliseconds() const { return stallMilliseconds; }
+};
+
+#endif // GPURINGBUFFER_H
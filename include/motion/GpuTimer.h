@@ -0,0 +1,87 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-pass GPU timing with GL_TIMESTAMP queries. Every scope writes a start and
+// end timestamp into a pool of FRAME_LATENCY frames; a frame's results are
+// read when its slot comes round again, so the CPU never waits for the GPU.
+// Frames whose queries are still pending by then are dropped, not waited on.
+// Scopes may nest. Without ARB_timer_query only CPU times are recorded.
+class GpuTimer
+{
+public:
+    static const int FRAME_LATENCY = 3;
+    static const int MAX_SCOPES = 16;
+
+    // Averages since the last resetStats, in milliseconds
+    struct ScopeStats
+    {
+        std::string name;
+        double cpuMilliseconds = 0.0;
+        double gpuMilliseconds = 0.0;
+        uint64_t cpuSamples = 0;
+        uint64_t gpuSamples = 0;
+    };
+
+private:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct FrameSlot
+    {
+        int scopeCount = 0;
+        const char *names[MAX_SCOPES];
+        GLuint queries[MAX_SCOPES * 2]; // Start and end timestamp per scope
+        double cpuMilliseconds[MAX_SCOPES];
+        bool pending = false;
+    };
+
+    bool available;
+    bool created;
+    FrameSlot frames[FRAME_LATENCY];
+    int frame;
+
+    int openScopes[MAX_SCOPES];
+    Clock::time_point openTimes[MAX_SCOPES];
+    int openCount;
+
+    std::vector<ScopeStats> stats;
+    uint64_t droppedFrames;
+    double frameGpuMilliseconds; // First start to last end of the latest collected frame
+    bool frameGpuReady;
+
+    ScopeStats &findStats(const char *name);
+    void collect(FrameSlot &slot);
+
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    // Needs a current GL context; returns false if GPU timing is unavailable
+    bool create();
+    void destroy();
+
+    // Collect the results of the frame FRAME_LATENCY frames back
+    void beginFrame();
+    void endFrame();
+
+    // name must outlive the frame (string literals)
+    void begin(const char *name);
+    void end();
+
+    bool isAvailable() const { return available; }
+    const std::vector<ScopeStats> &getStats() const { return stats; }
+    uint64_t getDroppedFrames() const { return droppedFrames; }
+    // GPU time of the latest collected frame; true once per frame with results
+    bool takeFrameGpuTime(double &milliseconds);
+    void resetStats();
+};
+
+#endif // GPUTIMER_H
@@ -0,0 +1,40 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+#include <GL/glew.h>
+
+// Offscreen OpenGL 3.3 core context for machines without a display. The
+// context is created through EGL on Mesa's surfaceless platform (falling back
+// to the default EGL display) and rendering goes to a framebuffer object that
+// stays bound as the draw target, so the renderer runs unchanged.
+// Needs a build with EGL (HAVE_EGL); otherwise create() fails.
+class HeadlessContext
+{
+private:
+    void *display; // EGLDisplay
+    void *context; // EGLContext
+    GLuint framebuffer;
+    GLuint colorRenderbuffer;
+    GLuint depthRenderbuffer;
+    int width;
+    int height;
+
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+    // Create the context and make it current on this thread
+    bool create(int framebufferWidth, int framebufferHeight);
+    // Once GL functions are loaded: create the framebuffer and bind it
+    bool createFramebuffer();
+    void destroy();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    GLuint getFramebuffer() const { return framebuffer; }
+};
+
+#endif // HEADLESSCONTEXT_H
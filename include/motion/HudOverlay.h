@@ -0,0 +1,106 @@
+#ifndef HUDOVERLAY_H
+#define HUDOVERLAY_H
+
+#include "FramePacer.h"
+#include "GLStateCache.h"
+#include <GL/glew.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-screen performance overlay: frame-time graph, interval/CPU/GPU
+// percentiles, draw counts and animation cost. Text comes from a 5x7 bitmap
+// font baked into a small texture at create; the panel, text and graph are
+// solid or textured quads from that atlas, streamed into one vertex buffer and
+// drawn with a single glDrawArrays. Numbers are reformatted a few times per
+// second from the FramePacer's histories; only the graph is rebuilt every
+// frame. The overlay times its own CPU work and shows it next to its GPU time.
+class HudOverlay
+{
+public:
+    static const size_t GRAPH_SAMPLES = 160; // Newest frame intervals in the graph
+
+    // Sampled by the caller at each refresh
+    struct Counters
+    {
+        const char *pacing = "";
+        GLStateCache::Stats glStats; // Last finished frame, including the HUD's own draw
+        size_t instances = 1;
+        uint64_t animationTicks = 0; // Totals since the animation thread was created
+        uint64_t animationBusyNanoseconds = 0;
+        double hudGpuMilliseconds = -1.0; // Negative when unknown
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Vertex
+    {
+        float x, y; // Pixels from the top left corner
+        float u, v;
+        uint32_t color; // RGBA8
+    };
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int vertexBuffer;
+    unsigned int atlas;
+    int viewportLocation;
+    int viewportWidth, viewportHeight; // Last values sent to the shader
+    bool created;
+
+    // Graph intervals, recorded every frame, visible or not
+    float graph[GRAPH_SAMPLES];
+    size_t graphNext;
+    Clock::time_point lastFrame;
+    bool hasLastFrame;
+
+    // Text and graph scale, updated at refresh
+    std::vector<std::string> lines;
+    float graphReference; // Median interval, drawn at half the graph height
+    bool textDirty;
+    int textScale;
+    std::vector<Vertex> textVertices;
+    std::vector<Vertex> vertices; // Everything drawn this frame, reused
+
+    // Refresh interval bookkeeping
+    Clock::time_point lastRefresh;
+    uint64_t framesSinceRefresh;
+    double hudCpuNanoseconds; // Own draw and refresh time since the last refresh
+    uint64_t lastAnimationTicks;
+    uint64_t lastAnimationBusyNanoseconds;
+
+    bool createAtlas();
+    bool createProgram();
+    void buildText(int scale);
+    void addQuad(std::vector<Vertex> &out, float x, float y, float width, float height, float u0, float v0, float u1,
+                 float v1, uint32_t color);
+    void addSolid(std::vector<Vertex> &out, float x, float y, float width, float height, uint32_t color);
+
+public:
+    HudOverlay();
+    ~HudOverlay();
+
+    HudOverlay(const HudOverlay &) = delete;
+    HudOverlay &operator=(const HudOverlay &) = delete;
+
+    // Needs a current GL context
+    bool create();
+    void destroy();
+
+    // After each swap; the graph interval is measured here
+    void endFrame();
+
+    // The text is stale (about four times a second)
+    bool needsRefresh() const;
+    // Recompute percentiles from the pacer's histories and reformat the text
+    void refresh(const Counters &counters, const FramePacer &pacer);
+
+    // Draw over the finished frame. Leaves depth testing on and blending off,
+    // as the renderer expects.
+    void draw(int width, int height);
+};
+
+#endif // HUDOVERLAY_H
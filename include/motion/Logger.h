@@ -0,0 +1,121 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+
+enum class LogLevel
+{
+    Debug,
+    Info,
+    Warning, // Warnings and errors go to stderr, the rest to stdout
+    Error
+};
+
+// LOG_INFO("Loaded " << count << " keyframes") formats the message on the
+// calling thread into a fixed buffer, with the usual stream manipulators; each
+// message is one line. Disabled levels skip the formatting entirely.
+#define LOG_AT(level, message)                                                                                        \
+    do                                                                                                                \
+    {                                                                                                                 \
+        if (Logger::isEnabled(level))                                                                                 \
+        {                                                                                                             \
+            LogLine logLine(level);                                                                                   \
+            logLine.stream() << message;                                                                              \
+        }                                                                                                             \
+    } while (0)
+#define LOG_DEBUG(message) LOG_AT(LogLevel::Debug, message)
+#define LOG_INFO(message) LOG_AT(LogLevel::Info, message)
+#define LOG_WARNING(message) LOG_AT(LogLevel::Warning, message)
+#define LOG_ERROR(message) LOG_AT(LogLevel::Error, message)
+
+// Leveled console logging that never blocks a hot loop on terminal or pipe
+// I/O. Between start and stop, messages go into a bounded lock-free ring with
+// any number of producers; a background thread writes them out and flushes
+// once per batch. When the ring is full the message is dropped and counted,
+// and the writer reports the count. Otherwise (before start, after stop, in
+// tools that never start it) each message is written and flushed directly,
+// in order with std::cout.
+class Logger
+{
+public:
+    static const size_t RING_SLOTS = 1024; // Power of two
+    static const size_t MESSAGE_BYTES = 480; // Longer messages are truncated
+
+private:
+    static std::atomic<int> minimumLevel;
+
+public:
+    static void setLevel(LogLevel level) { minimumLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+    static bool isEnabled(LogLevel level)
+    {
+        return static_cast<int>(level) >= minimumLevel.load(std::memory_order_relaxed);
+    }
+    // Accepts debug, info, warning or error
+    static bool parseLevel(const char *name, LogLevel &level);
+
+    // Start or stop the writer thread; stop writes out everything queued
+    static void start();
+    static void stop();
+
+    // One line without the newline; usually called through LOG_* and LogLine
+    static void write(LogLevel level, const char *text, size_t length);
+
+    // Messages lost to a full ring since the program started
+    static uint64_t getDroppedCount();
+};
+
+// A message being formatted into its own fixed buffer; written out when it
+// goes out of scope. Use it directly to build a line across several statements.
+class LogLine
+{
+private:
+    class Buffer : public std::streambuf
+    {
+    private:
+        char text[Logger::MESSAGE_BYTES];
+        bool truncated;
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            // Keep the stream usable and drop what does not fit
+            truncated = true;
+            return traits_type::not_eof(c);
+        }
+
+    public:
+        Buffer() : truncated(false) { setp(text, text + sizeof(text)); }
+        const char *data() const { return pbase(); }
+        size_t size() const { return static_cast<size_t>(pptr() - pbase()); }
+        bool isTruncated() const { return truncated; }
+        void markTruncated()
+        {
+            for (size_t i = 1; i <= 3 && i <= size(); i++)
+                text[size() - i] = '.';
+        }
+    };
+
+    LogLevel level;
+    Buffer buffer;
+    std::ostream out;
+
+public:
+    explicit LogLine(LogLevel lineLevel) : level(lineLevel), out(&buffer) {}
+    ~LogLine()
+    {
+        if (buffer.isTruncated())
+            buffer.markTruncated();
+        Logger::write(level, buffer.data(), buffer.size());
+    }
+
+    LogLine(const LogLine &) = delete;
+    LogLine &operator=(const LogLine &) = delete;
+
+    std::ostream &stream() { return out; }
+};
+
+#endif // LOGGER_H
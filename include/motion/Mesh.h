@@ -1,8 +1,12 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include "Meshlet.h"
+#include "OBJLoader.h"
+#include "VertexLayout.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -14,6 +18,35 @@
 class Mesh;
 Mesh *createDefaultCube();
 
+// Per-instance vertex attributes for instanced draws (locations 3-9)
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::mat3 normalMatrix;
+};
+
+// Level of detail: a triangle range inside the mesh's shared index buffer
+struct MeshLod
+{
+    unsigned int indexOffset;
+    unsigned int indexCount;
+    float error; // Largest simplification error in object-space units
+};
+
+// CPU-side mesh buffers already laid out for the GPU. Produced by loaders
+// (possibly on a worker thread) and consumed by Mesh uploads and the mesh cache.
+struct MeshData
+{
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    size_t vertexCount = 0;
+    std::vector<unsigned char> vertexData;
+    std::vector<unsigned int> indices;
+    std::vector<MeshLod> lods; // Empty, or level 0 first
+    std::vector<Meshlet> meshlets; // Partition of level 0, empty if not built
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
+
 // Mesh structure
 class Mesh
 {
@@ -22,6 +55,25 @@ private:
     std::vector<unsigned int> indices;
     unsigned int VAO, VBO, EBO;
 
+    // GPU-side layout and the bounds used to quantize positions
+    VertexFormat vertexFormat;
+    size_t vertexCount;
+    size_t indexCount;
+    glm::vec3 boundsMin, boundsMax;
+
+    // LOD chain sharing the vertex buffer; level 0 is the full mesh
+    std::vector<MeshLod> lods;
+
+    // Meshlet partition of level 0 plus per-frame draw lists for the survivors
+    std::vector<Meshlet> meshlets;
+    std::vector<int> drawCounts;
+    std::vector<const void *> drawOffsets;
+
+    void weldIfUnindexed();
+    void computeBounds(glm::vec3 &minBounds, glm::vec3 &maxBounds) const;
+    void packCompactVertices(const glm::vec3 &minBounds, const glm::vec3 &maxBounds, CompactVertex *out) const;
+    void setupVertexAttributes();
+
 public:
     Mesh();
     ~Mesh();
@@ -29,6 +81,66 @@ public:
     void cleanup();
     void setupBuffers();
     void render();
+    void render(size_t lod);
+
+    // Build simplified levels at the given triangle ratios (e.g. 0.5, 0.25).
+    // Welds the vertices into an indexed mesh first; levels build in parallel.
+    void generateLods(const std::vector<float> &triangleRatios);
+    size_t getLodCount() const { return lods.size(); }
+    const MeshLod &getLod(size_t lod) const { return lods[lod]; }
+    void setLods(const std::vector<MeshLod> &levels) { lods = levels; }
+
+    // Partition level 0 into meshlets (reorders its indices; welds first if needed)
+    void generateMeshlets();
+    size_t getMeshletCount() const { return meshlets.size(); }
+    void setMeshlets(const std::vector<Meshlet> &clusters) { meshlets = clusters; }
+
+    // Draw level 0 minus the meshlets outside the frustum or facing away.
+    // camera is the eye position in object space.
+    void renderCulled(const glm::mat4 &modelViewProjection, const glm::vec3 &camera, MeshletCullStats &stats);
+
+    // Instanced drawing of level 0: attach InstanceData records starting at
+    // offset in buffer (divisor 1) to the VAO, then draw instanceCount copies
+    // in one call. Ring-buffered data moves every frame, so bind before each draw.
+    void bindInstanceBuffer(unsigned int buffer, size_t offset);
+    void renderInstanced(size_t instanceCount);
+
+    // Upload vertex data already in the GPU layout of the current vertex format
+    void uploadBuffers(const void *vertexData, size_t numVertices, const unsigned int *indexData, size_t numIndices);
+
+    // Convert the CPU vertices into the GPU layout of the current vertex format
+    void buildMeshData(MeshData &out) const;
+    void uploadMeshData(const MeshData &data);
+
+    // Create empty GPU buffers to be filled later (staged uploads). The index
+    // count is passed separately because the indices may live in a mapping.
+    void allocateBuffers(const MeshData &layout, size_t layoutIndexCount);
+    unsigned int getVertexArray() const { return VAO; }
+    unsigned int getVertexBuffer() const { return VBO; }
+    unsigned int getIndexBuffer() const { return EBO; }
+
+    // Vertex format selection (takes effect on the next setupBuffers call)
+    void setVertexFormat(VertexFormat format) { vertexFormat = format; }
+    VertexFormat getVertexFormat() const { return vertexFormat; }
+    static size_t getVertexStride(VertexFormat format);
+
+    // Dequantization parameters for the vertex shader (identity for Float32)
+    glm::vec3 getPositionScale() const;
+    glm::vec3 getPositionOffset() const;
+
+    void setBounds(const glm::vec3 &minBounds, const glm::vec3 &maxBounds)
+    {
+        boundsMin = minBounds;
+        boundsMax = maxBounds;
+    }
+    const glm::vec3 &getBoundsMin() const { return boundsMin; }
+    const glm::vec3 &getBoundsMax() const { return boundsMax; }
+    glm::vec3 getBoundsCenter() const { return (boundsMin + boundsMax) * 0.5f; }
+    float getBoundingRadius() const { return glm::length(boundsMax - boundsMin) * 0.5f; }
+
+    size_t getVertexCount() const { return vertexCount; }
+    size_t getIndexCount() const { return indexCount; }
+    size_t getVertexBufferBytes() const { return vertexCount * getVertexStride(vertexFormat); }
 
     // Allow OBJLoader to access vertices and indices
     friend class OBJLoader;
@@ -37,21 +149,4 @@ public:
     friend Mesh *createDefaultCube();
 };
 
-// OBJ Loader class
-class OBJLoader
-{
-private:
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_uvs;
-    std::vector<glm::vec3> temp_normals;
-
-    glm::vec3 calculateNormal(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2);
-
-public:
-    bool loadOBJ(const std::string &path, Mesh &mesh);
-};
-
-// Utility function to create default cube
-Mesh *createDefaultCube();
-
 #endif // MESH_H
\ No newline at end of file
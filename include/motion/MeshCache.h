@@ -0,0 +1,134 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "Mesh.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Identifies the processed form of a source model on disk
+struct MeshCacheKey
+{
+    std::string sourcePath;
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    uint64_t contentHash = 0;
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    uint64_t processingHash = 0; // Settings that change the output, e.g. LOD ratios
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+private:
+    const unsigned char *data;
+    size_t size;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    const unsigned char *getData() const { return data; }
+    size_t getSize() const { return size; }
+
+    // Drop the whole pages of [begin, begin + bytes) from the working set once
+    // they have been consumed; they are read back from the file if touched again
+    void releasePages(const unsigned char *begin, size_t bytes) const;
+};
+
+// A cache entry left in its mapping. The vertex and index blobs point into
+// file; everything else is copied into layout, whose vertexData and indices
+// stay empty.
+struct MappedMeshData
+{
+    MappedFile file;
+    MeshData layout;
+    const unsigned char *vertexData = nullptr;
+    const unsigned int *indexData = nullptr;
+    size_t indexCount = 0;
+};
+
+// Binary cache of final GPU vertex and index buffers (.kfmesh files).
+// Blobs are page aligned so a mapped file can be handed straight to glBufferData.
+class MeshCache
+{
+private:
+    std::string directory;
+
+    // Blobs of a validated entry, pointing into the mapping
+    struct MappedEntry
+    {
+        const unsigned char *vertexData;
+        const unsigned int *indexData;
+        size_t vertexCount;
+        size_t indexCount;
+        glm::vec3 boundsMin, boundsMax;
+        std::vector<MeshLod> lods;
+        std::vector<Meshlet> meshlets;
+    };
+
+    bool mapEntry(const MeshCacheKey &key, MappedFile &file, MappedEntry &entry) const;
+
+public:
+    static const uint32_t VERSION = 4;
+
+    explicit MeshCache(const std::string &cacheDirectory);
+
+    // Stat and hash the source file; fails if it cannot be read
+    bool buildKey(const std::string &sourcePath, VertexFormat format, MeshCacheKey &key) const;
+    std::string getCachePath(const MeshCacheKey &key) const;
+
+    // Map a matching cache entry and upload it; false on miss or stale entry
+    bool load(const MeshCacheKey &key, Mesh &mesh) const;
+
+    // Map a matching cache entry and copy it into CPU buffers (no GL calls)
+    bool loadData(const MeshCacheKey &key, MeshData &data) const;
+
+    // Map a matching cache entry and keep it mapped (no GL calls, no copies)
+    bool map(const MeshCacheKey &key, MappedMeshData &mapped) const;
+
+    // Write GPU-ready buffers
+    bool store(const MeshCacheKey &key, const MeshData &data) const;
+};
+
+// Incremental writer for one cache entry. Vertex bytes are appended in chunks;
+// finish() writes the indices and header and publishes the entry atomically.
+class MeshCacheWriter
+{
+private:
+    std::ofstream out;
+    std::string path;
+    std::string tempPath;
+    MeshCacheKey key;
+    uint64_t vertexBytes;
+
+public:
+    MeshCacheWriter();
+    ~MeshCacheWriter();
+
+    bool open(const MeshCache &cache, const MeshCacheKey &entryKey);
+    bool writeVertices(const void *data, size_t bytes);
+    bool finish(size_t vertexCount, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax,
+                const unsigned int *indices, size_t indexCount,
+                const std::vector<MeshLod> &lods = std::vector<MeshLod>(),
+                const std::vector<Meshlet> &meshlets = std::vector<Meshlet>());
+
+    // Drop an unfinished entry
+    void abort();
+};
+
+// 64-bit FNV-1a hash used for cache keys
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+#endif // MESHCACHE_H
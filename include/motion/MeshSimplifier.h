@@ -0,0 +1,30 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Quadric error metric simplification (Garland-Heckbert) using half-edge
+// collapses, so every simplified triangle still references the original
+// vertices and all levels can share one vertex buffer.
+class MeshSimplifier
+{
+public:
+    // Merge bit-identical interleaved vertices (stride floats each) and
+    // return the index buffer that rebuilds the original triangle list
+    static std::vector<unsigned int> weldVertices(std::vector<float> &vertices, size_t stride);
+
+    // Reduce the indexed triangle list to at most targetTriangles triangles.
+    // positions points at the first position of vertex 0 and advances by
+    // stride floats per vertex. resultError receives the largest collapse
+    // error as an object-space distance. Each surviving corner keeps the
+    // original vertex on its side of a normal/UV seam; only a collapse that
+    // drags a seam vertex off its seam leaves the far side with the one
+    // vertex at the new position.
+    static std::vector<unsigned int> simplify(const float *positions, size_t stride, size_t vertexCount,
+                                              const std::vector<unsigned int> &indices, size_t targetTriangles,
+                                              float &resultError);
+};
+
+#endif // MESHSIMPLIFIER_H
@@ -0,0 +1,52 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+// Cluster of up to MAX_VERTICES vertices / MAX_TRIANGLES triangles stored as a
+// contiguous range of the index buffer, with bounds for per-cluster culling
+struct Meshlet
+{
+    unsigned int indexOffset;
+    unsigned int indexCount;
+    glm::vec3 center; // Bounding sphere in object space
+    float radius;
+    glm::vec3 coneAxis; // Average facing direction of the triangles
+    float coneCutoff;   // sin of the cone half-angle; 1 when the cone cannot cull
+};
+
+struct MeshletCullStats
+{
+    size_t total = 0;
+    size_t frustumCulled = 0;
+    size_t backfaceCulled = 0;
+    size_t drawRanges = 0;
+};
+
+class MeshletBuilder
+{
+public:
+    static const size_t MAX_VERTICES = 64;
+    static const size_t MAX_TRIANGLES = 124;
+
+    // Reorder the triangles in indices[firstIndex, firstIndex + indexCount) into
+    // meshlets grown over shared vertices and append their descriptors.
+    // positions points at the first position of vertex 0 and advances by
+    // stride floats per vertex.
+    static void build(const float *positions, size_t stride, std::vector<unsigned int> &indices,
+                      size_t firstIndex, size_t indexCount, std::vector<Meshlet> &meshlets);
+
+    // Frustum and normal cone test. planes are object-space frustum planes
+    // (xyz normal pointing inside, w distance); camera is the object-space eye.
+    // Surviving index ranges are written as counts/offsets for glMultiDrawElements,
+    // with neighbouring survivors merged into one range.
+    static void cull(const std::vector<Meshlet> &meshlets, const glm::vec4 planes[6], const glm::vec3 &camera,
+                     std::vector<int> &counts, std::vector<const void *> &offsets, MeshletCullStats &stats);
+
+    // Object-space frustum planes of a model-view-projection matrix
+    static void extractFrustumPlanes(const glm::mat4 &modelViewProjection, glm::vec4 planes[6]);
+};
+
+#endif // MESHLET_H
@@ -53,6 +53,9 @@ private:
     glm::vec3 fastBSplineEuler(float t, const SegmentData &seg) const;
     glm::vec3 normalizeAngles(glm::vec3 angles, glm::vec3 reference) const;
 
+    // Times the private hot paths (bench/motion_benchmark.cpp)
+    friend class MotionControllerBenchmark;
+
 public:
     void addKeyFrame(const KeyFrame &kf);
     void addMultipleKeyFrames(const std::vector<KeyFrame> &kfs);
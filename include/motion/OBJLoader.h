@@ -0,0 +1,70 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "VertexLayout.h"
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Mesh;
+
+// Receives expanded vertices in the GPU layout, one chunk at a time, along
+// with the expected total size of the stream
+typedef std::function<bool(const unsigned char *data, size_t bytes, size_t totalBytes)> VertexChunkSink;
+
+// Summary of a streaming OBJ ingestion
+struct OBJStreamStats
+{
+    size_t vertexCount = 0;
+    size_t triangleCount = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    size_t arenaBytes = 0; // Attribute arenas plus the chunk buffer
+};
+
+// One face corner, resolved to 0-based attribute indices; -1 when absent or out of range
+struct OBJIndex
+{
+    int position;
+    int uv;
+    int normal;
+};
+
+// An OBJ file as parsed, before triangulation
+struct OBJData
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<OBJIndex> corners;       // Corners of all faces in file order
+    std::vector<unsigned int> faceEnds;  // One past the last corner of each face
+    std::vector<unsigned int> triangles; // Corner indices, three per triangle (see triangulate)
+};
+
+// OBJ Loader class. Needs no GL context; only loadOBJ(path, Mesh &) touches Mesh.
+class OBJLoader
+{
+public:
+    // Interleaved position(3) + normal(3) + texcoord(2) vertices, three per triangle
+    bool loadOBJ(const std::string &path, std::vector<float> &vertices);
+    bool loadOBJ(const std::string &path, Mesh &mesh);
+
+    // The phases of loadOBJ, for timing them separately. parse reads the
+    // attributes and face corners, triangulate fans faces into triangles
+    // (dropping ones with invalid positions), expand writes the vertices with
+    // face normals for corners that have none.
+    static bool parse(const std::string &path, OBJData &out);
+    static void triangulate(OBJData &obj);
+    static void expand(const OBJData &obj, std::vector<float> &vertices);
+
+    // Bounded-memory ingestion for very large files. A pre-scan sizes flat
+    // attribute arenas and finds the bounds, then expanded vertices are packed
+    // into a reusable chunk and handed to sink. Fails instead of exceeding
+    // memoryBudget bytes.
+    bool streamOBJ(const std::string &path, VertexFormat format, size_t memoryBudget,
+                   const VertexChunkSink &sink, OBJStreamStats &stats);
+};
+
+#endif // OBJLOADER_H
@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// PROFILE_SCOPE("name") times the enclosing scope into a ring of events owned
+// by the calling thread, for viewing in chrome://tracing or Perfetto. Names
+// must be string literals. Both macros compile to nothing unless
+// MOTION_PROFILING is defined (CMake option ENABLE_PROFILING).
+#ifdef MOTION_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
+
+class Profiler
+{
+public:
+    // Per thread; older events are overwritten
+    static const size_t EVENTS_PER_THREAD = 1 << 16;
+
+    struct Event
+    {
+        const char *name;
+        int64_t begin; // Nanoseconds on the steady clock
+        int64_t end;
+    };
+
+    // Whether PROFILE_SCOPE records anything in this build
+    static bool isCompiledIn();
+
+    static int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Append to the calling thread's ring: one store and a release, no locks.
+    // The first call on a thread allocates and registers its ring.
+    static void record(const char *name, int64_t begin, int64_t end);
+
+    // Label the calling thread in the trace
+    static void setThreadName(const char *name);
+
+    // Every thread's retained events as Chrome trace_event JSON. Threads may
+    // keep recording meanwhile; events overwritten during the copy are dropped.
+    static bool writeChromeTrace(const std::string &path);
+};
+
+class ProfileScope
+{
+private:
+    const char *name;
+    int64_t begin;
+
+public:
+    explicit ProfileScope(const char *scopeName) : name(scopeName), begin(Profiler::now()) {}
+    ~ProfileScope() { Profiler::record(name, begin, Profiler::now()); }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#endif // PROFILER_H
@@ -6,10 +6,30 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "GLStateCache.h"
+#include "GpuRingBuffer.h"
+#include "Meshlet.h"
+#include "ShaderCache.h"
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <vector>
 
-// Forward declaration
+// Forward declarations
 class Mesh;
+struct InstanceData;
+
+// Per-frame uniform block shared by all draws (std140 layout, see FrameData in
+// the shaders). vec3 values are padded to vec4 as std140 requires.
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPosition;
+    glm::vec4 lightColor;
+    glm::vec4 viewPosition;
+};
+static_assert(sizeof(FrameData) == 176, "FrameData must match the std140 block layout");
 
 // Renderer class to handle OpenGL rendering
 class Renderer
@@ -17,6 +37,45 @@ class Renderer
 private:
     unsigned int shaderProgram;
 
+    // Per-object uniform locations, resolved once after linking
+    struct UniformLocations
+    {
+        int model;
+        int normalMatrix;
+        int positionScale;
+        int positionOffset;
+        int objectColor;
+    } uniforms;
+
+    // Instanced variant: same fragment stage, model and normal matrices come
+    // from a streamed per-instance vertex buffer
+    unsigned int instancedProgram;
+    UniformLocations instancedUniforms;
+    InstanceData *mappedInstances; // Latest mapInstances allocation
+    std::vector<InstanceData> fallbackInstances;
+
+    // Per-frame dynamic data: FrameData blocks and instance records live in
+    // persistently mapped rings so uploads never sync with the GPU
+    static const unsigned int FRAME_DATA_BINDING = 0;
+    GpuRingBuffer frameDataRing;
+    GpuRingBuffer instanceRing;
+    FrameData frameData;
+    glm::vec3 frameCameraPosition;
+
+    // Draws queued by submit and issued sorted by key at flush, so objects
+    // sharing a program, mesh or material reuse the state already bound.
+    // Key bits: program (16) | vertex array (24) | material color (24)
+    struct DrawItem
+    {
+        uint64_t key;
+        Mesh *mesh;
+        glm::mat4 model;
+        glm::vec3 color;
+        glm::mat3 normalMatrix; // Computed once at submit
+    };
+    std::vector<DrawItem> drawQueue;
+    void queueDraw(Mesh *mesh, const glm::mat4 &model, const glm::mat3 &normalMatrix, const glm::vec3 &color);
+
     // Camera state
     float cameraDistance;
     float cameraYaw;
@@ -31,23 +90,83 @@ private:
     // Window dimensions
     int windowWidth, windowHeight;
 
+    // Projection and LOD selection
+    float fieldOfView;
+    float lodPixelError;
+    size_t lastLod;
+    MeshletCullStats cullStats;
+
+    size_t selectLod(const Mesh *mesh, const glm::mat4 &model, const glm::vec3 &cameraPos) const;
+
     // Shader compilation and loading
     std::string loadShaderFromFile(const std::string &filepath);
     unsigned int compileShader(const std::string &source, GLenum type);
-    unsigned int loadShadersFromFiles(const std::string &vertexPath, const std::string &fragmentPath);
+    bool checkShader(unsigned int shader, GLenum type);
+    unsigned int loadShadersFromFiles(const std::string &vertexPath, const std::string &fragmentPath,
+                                      const std::string &defines = "");
     void setupShaders();
+    ShaderCache shaderCache;
+
+    // A program build split in two so compilation can overlap with frames:
+    // start issues compile and link, finish checks the results
+    struct PendingProgram
+    {
+        unsigned int program = 0;
+        unsigned int vertexShader = 0;
+        unsigned int fragmentShader = 0;
+        uint64_t cacheKey = 0;
+        bool fromCache = false;
+        uint64_t startFrame = 0; // beginFrame count when the build was issued
+        std::chrono::high_resolution_clock::time_point start;
+    };
+    bool startProgramBuild(const std::string &vertexPath, const std::string &fragmentPath,
+                           const std::string &defines, PendingProgram &pending);
+    bool isProgramBuildDone(const PendingProgram &pending) const;
+    unsigned int finishProgramBuild(PendingProgram &pending);
+    void cancelProgramBuild(PendingProgram &pending);
+
+    // Hot reload: sources of the live programs and their background rebuilds
+    bool parallelShaderCompile; // KHR/ARB_parallel_shader_compile enabled
+    std::string vertexShaderPath, fragmentShaderPath, shaderDefines;
+    std::string instancedVertexShaderPath, instancedFragmentShaderPath;
+    PendingProgram pendingProgram;
+    PendingProgram pendingInstancedProgram;
+    uint64_t frameCounter; // beginFrame calls so far
+    void enableParallelShaderCompile();
+    void swapReloadedProgram(PendingProgram &pending, unsigned int &program, UniformLocations &locations);
+    bool setupProgramBindings(unsigned int program, UniformLocations &locations);
 
 public:
     Renderer();
     ~Renderer();
 
+    // Cache linked programs under directory/shaders; call before initialize.
+    // An empty directory (the default) always compiles from source
+    void setShaderCacheDirectory(const std::string &directory) { shaderCache.setDirectory(directory); }
+
     bool initialize();
-    bool initializeWithShaderFiles(const std::string &vertexPath, const std::string &fragmentPath);
+    // defines is inserted after the #version line, e.g. "#define NAME\n"
+    bool initializeWithShaderFiles(const std::string &vertexPath, const std::string &fragmentPath,
+                                   const std::string &defines = "");
+
+    // Optional program for renderInstanced, built with the defines given to
+    // initializeWithShaderFiles; without it instances draw one by one
+    bool loadInstancedShaders(const std::string &vertexPath, const std::string &fragmentPath);
     void cleanup();
 
+    // Rebuild the programs from their shader files without blocking the frame.
+    // Each new program replaces the old one at a later beginFrame once the
+    // driver reports it complete. Without parallel compilation the frame that
+    // issued the rebuild still draws with the old program and the following
+    // beginFrame waits for whatever compile work is left. If it fails to
+    // compile or link the old one stays.
+    void reloadShaders();
+
     // Camera controls
     glm::vec3 getCameraPosition() const;
     void resetCamera();
+    // Place the camera on its orbit around the target, in degrees
+    void setCameraOrbit(float yaw, float pitch, float distance);
 
     // Event callbacks
     void onFramebufferSize(int width, int height);
@@ -57,13 +176,55 @@ public:
 
     // Rendering
     void clear();
-    void renderMesh(Mesh *mesh, const glm::mat4 &model);
+
+    // Update camera and light data for this frame; call once before renderMesh
+    void beginFrame();
+    // Flush queued draws and fence this frame's ring buffer regions; call
+    // once after the last draw
+    void endFrame();
+
+    // Queue mesh for drawing with the given material color. rigidTransform:
+    // model is rotation plus translation, so its rotation block is already the
+    // normal matrix and no inverse is needed
+    void submit(Mesh *mesh, const glm::mat4 &model, bool rigidTransform = false,
+                const glm::vec3 &color = glm::vec3(0.8f, 0.4f, 0.2f));
+    // Issue the queued draws in key order
+    void flush();
+    // Same as submit with the default material; the draw happens at the next flush
+    void renderMesh(Mesh *mesh, const glm::mat4 &model, bool rigidTransform = false);
+
+    // Draw count copies of mesh, one per model matrix, in a single draw call
+    void renderInstanced(Mesh *mesh, const glm::mat4 *models, size_t count, bool rigidTransforms = false);
+
+    // Zero-copy variant: fill the returned GPU-visible records (write only,
+    // valid until drawInstances), then draw them
+    InstanceData *mapInstances(size_t count);
+    void drawInstances(Mesh *mesh, size_t count);
+
+    // Frames in which the CPU had to wait for the GPU to release a ring region
+    uint64_t getRingStallCount() const { return frameDataRing.getStallCount() + instanceRing.getStallCount(); }
+    double getRingStallMilliseconds() const
+    {
+        return frameDataRing.getStallMilliseconds() + instanceRing.getStallMilliseconds();
+    }
+
+    // LOD selection: use the coarsest level whose error stays under this many pixels
+    void setLodPixelError(float pixels) { lodPixelError = pixels; }
+    size_t getLastLod() const { return lastLod; }
+    const MeshletCullStats &getCullStats() const { return cullStats; }
+
+    // Draw calls and GL state changes of the last finished frame
+    const GLStateCache::Stats &getFrameStats() const { return GLStateCache::get().getFrameStats(); }
 
     // Getters
     int getWindowWidth() const { return windowWidth; }
     int getWindowHeight() const { return windowHeight; }
 };
 
+// Matrix that transforms normals by model: the rotation block for rigid
+// transforms, the inverse transpose otherwise
+glm::mat3 computeNormalMatrix(const glm::mat4 &model, bool rigidTransform);
+
 // Default shader source code (fallback if files not found)
 extern const char *defaultVertexShaderSource;
 extern const char *defaultFragmentShaderSource;
@@ -0,0 +1,41 @@
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+// Linked program binaries on disk (.kfprog files), one per key. Binaries are
+// only valid for the driver that produced them, so the key covers the driver
+// strings as well as the sources and defines. The driver may still reject a
+// binary (e.g. after an update that kept the version string); load() then
+// removes the entry and the caller compiles from source.
+class ShaderCache
+{
+private:
+    std::string directory;
+    int supported; // -1 until queried (needs a current context)
+
+    std::string getCachePath(uint64_t key) const;
+
+public:
+    static const uint32_t VERSION = 1;
+
+    // An empty directory disables the cache
+    explicit ShaderCache(const std::string &cacheDirectory = "");
+
+    void setDirectory(const std::string &cacheDirectory) { directory = cacheDirectory; }
+    // ARB_get_program_binary present and at least one binary format offered
+    bool isEnabled();
+
+    uint64_t buildKey(const std::string &vertexSource, const std::string &fragmentSource,
+                      const std::string &defines) const;
+
+    // Create a program from a cached binary; 0 on miss or rejected binary
+    unsigned int load(uint64_t key);
+
+    // program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+    bool store(uint64_t key, unsigned int program);
+};
+
+#endif // SHADERCACHE_H
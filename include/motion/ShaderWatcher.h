@@ -0,0 +1,50 @@
+#ifndef SHADERWATCHER_H
+#define SHADERWATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Reports changes to a set of files. On Linux the parent directories are
+// watched with inotify, which also catches editors that save by renaming a
+// temporary file over the original; elsewhere modification times are polled.
+// Bursts of events are merged: poll() fires once the files have been quiet
+// for a short moment, so a half-written file is never picked up.
+class ShaderWatcher
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct WatchedFile
+    {
+        std::string directory;
+        std::string name;
+        int watch; // inotify watch descriptor
+        std::filesystem::file_time_type lastWrite;
+    };
+
+    std::vector<WatchedFile> files;
+    int inotifyFd;
+    bool changePending;
+    Clock::time_point lastChange;
+    Clock::time_point lastScan;
+
+    bool readEvents();
+    bool scanTimestamps();
+
+public:
+    ShaderWatcher();
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher &) = delete;
+    ShaderWatcher &operator=(const ShaderWatcher &) = delete;
+
+    bool watch(const std::vector<std::string> &paths);
+    void stop();
+
+    // Non-blocking; true once after watched files changed and settled
+    bool poll();
+};
+
+#endif // SHADERWATCHER_H
@@ -0,0 +1,52 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer handoff of the latest value.
+// The writer fills its private slot and publishes it by swapping it with the
+// shared middle slot; the reader swaps the middle slot with its own only when
+// something new was published. Neither side ever waits, and the reader always
+// sees the most recent complete value (intermediate ones are skipped).
+template <typename T>
+class TripleBuffer
+{
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH = 0x4; // Middle slot holds an unread value
+
+    T slots[3];
+    std::atomic<uint8_t> middle;
+    uint8_t writeIndex; // Owned by the writer thread
+    uint8_t readIndex;  // Owned by the reader thread
+
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Writer: the slot to fill next; stays valid until publish()
+    T &writeSlot() { return slots[writeIndex]; }
+
+    void publish()
+    {
+        writeIndex = middle.exchange(static_cast<uint8_t>(writeIndex | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader: switch to the newest published value, if any; false if the
+    // current one is still the latest
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Reader: the value picked by the last update(); stays valid until the next one
+    const T &readSlot() const { return slots[readIndex]; }
+};
+
+#endif // TRIPLEBUFFER_H
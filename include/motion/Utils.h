@@ -2,6 +2,9 @@
 #define UTILS_H
 
 #include "MotionController.h"
+#include "FrameExporter.h"
+#include "FramePacer.h"
+#include "Logger.h"
 #include "Mesh.h"
 #include <string>
 #include <vector>
@@ -11,7 +14,35 @@ bool parseKeyFramesFromString(const std::string &keyframeStr, OptimizedMotionCon
 void setupDefaultKeyFrames(OptimizedMotionController *controller);
 
 // Mesh loading utilities
-bool loadMeshFromOBJ(const std::string &filename, Mesh **currentMesh);
+struct MeshLoadOptions
+{
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    bool useCache = true;
+    std::string cacheDirectory = ".kfcache";
+
+    // Bounded-memory streaming ingestion (see OBJLoader::streamOBJ)
+    bool streaming = false;
+    size_t memoryBudget = 512 * 1024 * 1024;
+
+    // Triangle ratios of the simplified levels (see Mesh::generateLods)
+    std::vector<float> lodRatios;
+
+    // Cluster level 0 for per-meshlet culling (see Mesh::generateMeshlets)
+    bool buildMeshlets = false;
+};
+
+bool loadMeshFromOBJ(const std::string &filename, Mesh **currentMesh, const MeshLoadOptions &options = MeshLoadOptions());
+
+struct MappedMeshData;
+
+// Produce GPU-ready CPU buffers without touching GL (safe on worker threads).
+// With mapped, a cached or streamed model is left in its cache file mapping
+// instead of being copied into data; check mapped->vertexData to tell which.
+bool loadMeshData(const std::string &filename, const MeshLoadOptions &options, MeshData &data,
+                  MappedMeshData *mapped = nullptr);
+
+// Process statistics
+size_t getPeakRSSBytes();
 
 // Command line parsing
 struct ProgramConfig
@@ -22,9 +53,44 @@ struct ProgramConfig
     std::string keyframeString = "";
     bool keyframesProvided = false;
     bool showHelp = false;
+    VertexFormat vertexFormat = VertexFormat::Float32;
+    bool useMeshCache = true;
+    std::string meshCacheDirectory = ".kfcache";
+    bool useShaderCache = true;
+    bool watchShaders = true; // Recompile shaders when their files change
+    double tickRate = 60.0;   // Animation evaluations per second; frames interpolate between them
+    float playbackRate = 0.5f; // Animation seconds per wall-clock second
+    PacingMode pacingMode = PacingMode::VSync;
+    double frameRateCap = 0.0;        // Capped pacing target in frames per second
+    float frameReportInterval = 0.0f; // Seconds between frame time reports, 0 = only with P
+    std::string tracePath;            // Chrome trace written at exit; needs an ENABLE_PROFILING build
+    bool showHud = false;             // Start with the performance HUD visible (H toggles it)
+    LogLevel logLevel = LogLevel::Info;
+    bool streamMeshLoading = false;
+    size_t streamMemoryBudget = 512 * 1024 * 1024;
+    bool asyncMeshLoading = true;
+    size_t uploadBudgetBytes = 4 * 1024 * 1024; // Per-frame GPU upload budget
+    std::vector<float> lodRatios;
+    float lodPixelError = 1.0f; // Largest allowed LOD error on screen
+    bool buildMeshlets = false;
+    size_t instanceCount = 1;         // Animated copies drawn with one instanced call
+    bool benchmarkInstances = false;  // Time 1..100k instances, then exit
+    bool benchmarkVertexShader = false; // Time normal matrix variants, then exit
+    bool headless = false;              // Offscreen EGL context and framebuffer, no window
+    int headlessWidth = 800;
+    int headlessHeight = 600;
+    size_t headlessFrames = 300;
+    size_t benchmarkFrames = 0;       // --bench: frames per mode, 0 = off
+    std::string benchmarkOutput = "bench_results.json";
+    std::string benchmarkBaseline;    // Compare against these results when set
+    double benchmarkThreshold = 0.10; // Relative slowdown counted as a regression
+    bool exportFrames = false; // Render the animation's time range to images, then exit
+    double exportFps = 30.0;
+    ExportOptions exportOptions;
 
     std::string vertexShaderPath = "assets/shaders/vertex.glsl";
     std::string fragmentShaderPath = "assets/shaders/fragment.glsl";
+    std::string instancedVertexShaderPath = "assets/shaders/vertex_instanced.glsl";
 };
 
 bool parseCommandLine(int argc, char *argv[], ProgramConfig &config);
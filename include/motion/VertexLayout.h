@@ -0,0 +1,33 @@
+#ifndef VERTEXLAYOUT_H
+#define VERTEXLAYOUT_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// GPU vertex layouts supported by Mesh::setupBuffers
+enum class VertexFormat
+{
+    Float32, // position(3) + normal(3) + texcoord(2) as floats, 32 bytes
+    Compact  // unorm16 position + 2_10_10_10 normal + half texcoord, 16 bytes
+};
+
+// Compact vertex layout. Positions are normalized against the mesh bounds and
+// expanded in the vertex shader through positionScale/positionOffset.
+struct CompactVertex
+{
+    uint16_t position[4]; // x, y, z, padding
+    uint32_t normal;      // GL_INT_2_10_10_10_REV
+    uint16_t texcoord[2]; // GL_HALF_FLOAT
+};
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must be 16 bytes");
+
+size_t vertexStride(VertexFormat format);
+
+// Extent of the bounds with degenerate axes set to 1
+glm::vec3 quantizationScale(const glm::vec3 &minBounds, const glm::vec3 &maxBounds);
+
+// Pack one interleaved float vertex (position, normal, texcoord)
+void packCompactVertex(const float *src, const glm::vec3 &offset, const glm::vec3 &scale, CompactVertex &dst);
+
+#endif // VERTEXLAYOUT_H
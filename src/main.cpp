@@ -1,27 +1,49 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
+#include <thread>
+#include <vector>
 
+#include "motion/AnimationThread.h"
+#include "motion/AsyncMeshLoader.h"
+#include "motion/BenchmarkResults.h"
+#include "motion/FrameExporter.h"
+#include "motion/FramePacer.h"
+#include "motion/GpuTimer.h"
+#include "motion/HeadlessContext.h"
+#include "motion/HudOverlay.h"
+#include "motion/Logger.h"
 #include "motion/Mesh.h"
 #include "motion/MotionController.h"
+#include "motion/Profiler.h"
 #include "motion/Renderer.h"
+#include "motion/ShaderWatcher.h"
 #include "motion/Utils.h"
 
 // Global state
 OptimizedMotionController *motionController = nullptr;
 Mesh *currentMesh = nullptr;
 Renderer *renderer = nullptr;
+AsyncMeshLoader *meshLoader = nullptr;
+GpuTimer *gpuTimer = nullptr;
+ShaderWatcher *shaderWatcher = nullptr;
+AnimationThread *animation = nullptr;
+FramePacer *framePacer = nullptr;
+HeadlessContext *headless = nullptr;
+HudOverlay *hud = nullptr;
+bool modelLoadFailed = false; // -m named a model that could not be loaded
 
-// Animation state
-float currentTime = 0.0f;
+// Animation state (time itself lives on the animation thread)
 bool useQuaternions = true;
 bool useBSpline = false;
 
 // Performance monitoring
 bool showPerformanceStats = false;
-float frameTime = 0.0f;
+bool showHud = false;
 int frameCount = 0;
 float fpsTimer = 0.0f;
 float averageFPS = 0.0f;
@@ -29,6 +51,9 @@ float averageFPS = 0.0f;
 // Configuration
 ProgramConfig config;
 
+// Per-instance model matrices, rebuilt every frame
+std::vector<glm::mat4> instanceModels;
+
 // GLFW callback wrappers
 void framebufferSizeCallback(GLFWwindow *window, int width, int height)
 {
@@ -62,26 +87,65 @@ void keyCallback(GLFWwindow *window, int key, int /*scancode*/, int action, int
         {
         case GLFW_KEY_Q:
             useQuaternions = !useQuaternions;
-            std::cout << "Using " << (useQuaternions ? "Quaternions" : "Euler Angles") << std::endl;
+            if (animation)
+                animation->setInterpolation(useQuaternions, useBSpline);
+            LOG_INFO("Using " << (useQuaternions ? "Quaternions" : "Euler Angles"));
             break;
         case GLFW_KEY_S:
             useBSpline = !useBSpline;
-            std::cout << "Using " << (useBSpline ? "B-Spline" : "Catmull-Rom") << " interpolation" << std::endl;
+            if (animation)
+                animation->setInterpolation(useQuaternions, useBSpline);
+            LOG_INFO("Using " << (useBSpline ? "B-Spline" : "Catmull-Rom") << " interpolation");
             break;
         case GLFW_KEY_R:
-            currentTime = 0.0f;
-            std::cout << "Reset animation" << std::endl;
+            if (animation)
+                animation->resetTime();
+            LOG_INFO("Reset animation");
             break;
         case GLFW_KEY_C:
             if (renderer)
             {
                 renderer->resetCamera();
-                std::cout << "Reset camera" << std::endl;
+                LOG_INFO("Reset camera");
             }
             break;
         case GLFW_KEY_P:
             showPerformanceStats = !showPerformanceStats;
-            std::cout << "Performance stats: " << (showPerformanceStats ? "ON" : "OFF") << std::endl;
+            LOG_INFO("Performance stats: " << (showPerformanceStats ? "ON" : "OFF"));
+            if (gpuTimer)
+                gpuTimer->resetStats();
+            if (animation)
+                animation->collectStats();
+            break;
+        case GLFW_KEY_V:
+            if (framePacer)
+            {
+                // Cycle vsync -> adaptive -> uncapped -> capped (if a cap is configured)
+                PacingMode next = PacingMode::VSync;
+                switch (framePacer->getMode())
+                {
+                case PacingMode::VSync:
+                    next = PacingMode::Adaptive;
+                    break;
+                case PacingMode::Adaptive:
+                    next = PacingMode::Uncapped;
+                    break;
+                case PacingMode::Uncapped:
+                    next = config.frameRateCap > 0.0 ? PacingMode::Capped : PacingMode::VSync;
+                    break;
+                case PacingMode::Capped:
+                    next = PacingMode::VSync;
+                    break;
+                }
+                framePacer->setMode(next, config.frameRateCap);
+            }
+            break;
+        case GLFW_KEY_H:
+            showHud = !showHud;
+            LOG_INFO("Performance HUD: " << (showHud ? "ON" : "OFF"));
+            break;
+        case GLFW_KEY_T:
+            Profiler::writeChromeTrace(config.tracePath.empty() ? "trace.json" : config.tracePath);
             break;
         case GLFW_KEY_ESCAPE:
             glfwSetWindowShouldClose(window, true);
@@ -90,40 +154,139 @@ void keyCallback(GLFWwindow *window, int key, int /*scancode*/, int action, int
     }
 }
 
-void render()
+// Grid spacing that keeps instances of the current mesh apart
+static float instanceSpacing()
 {
-    if (!renderer || !motionController || !currentMesh)
-        return;
+    return std::max(currentMesh->getBoundingRadius() * 2.5f, 0.5f);
+}
+
+// Lay instances out on a grid and offset each one along the animation
+static glm::mat4 instanceModel(size_t index, size_t count, float time)
+{
+    return instanceTransform(*motionController, index, count, instanceSpacing(), time, useQuaternions, useBSpline);
+}
+
+void computeInstanceModels(size_t count, float time)
+{
+    instanceModels.resize(count);
+    for (size_t i = 0; i < count; i++)
+        instanceModels[i] = instanceModel(i, count, time);
+}
 
-    // Performance timing
-    auto renderStart = std::chrono::high_resolution_clock::now();
+// Evaluate the animation straight into the renderer's mapped instance buffer
+bool writeInstances(size_t count, float time)
+{
+    InstanceData *instances = renderer->mapInstances(count);
+    if (!instances)
+        return false;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::mat4 model = instanceModel(i, count, time);
+        instances[i].model = model;
+        instances[i].normalMatrix = computeNormalMatrix(model, true); // Motion transforms are rigid
+    }
+    return true;
+}
 
+// Draw instanceModels, all instances in one draw
+void drawInstances()
+{
+    // Pass timings; GPU results arrive a few frames late
+    gpuTimer->beginFrame();
+    gpuTimer->begin("clear");
     renderer->clear();
+    gpuTimer->end();
 
-    // Get the transformation matrix from motion controller with timing
-    auto transformStart = std::chrono::high_resolution_clock::now();
-    glm::mat4 model = motionController->getTransformationMatrix(currentTime, useQuaternions, useBSpline);
-    auto transformEnd = std::chrono::high_resolution_clock::now();
+    renderer->beginFrame();
 
-    if (showPerformanceStats)
+    gpuTimer->begin("draw");
+    if (instanceModels.size() > 1)
+        renderer->renderInstanced(currentMesh, instanceModels.data(), instanceModels.size(), true);
+    else
+        renderer->renderMesh(currentMesh, instanceModels[0], true);
+    renderer->endFrame();
+    gpuTimer->end();
+
+    // Drawn last, over the finished frame; its draw counts toward the next frame's stats
+    if (hud && showHud)
     {
-        auto transformDuration = std::chrono::duration_cast<std::chrono::microseconds>(transformEnd - transformStart);
-        if (transformDuration.count() > 50)
-        { // Only show if > 50 microseconds
-            std::cout << "Transform calculation: " << transformDuration.count() << "µs" << std::endl;
-        }
+        gpuTimer->begin("hud");
+        hud->draw(renderer->getWindowWidth(), renderer->getWindowHeight());
+        gpuTimer->end();
+    }
+    gpuTimer->endFrame();
+}
+
+// Hand the HUD what it shows besides its own frame history
+void refreshHud()
+{
+    HudOverlay::Counters counters;
+    counters.pacing = pacingModeName(framePacer->getMode());
+    counters.glStats = renderer->getFrameStats();
+    counters.instances = config.instanceCount;
+    counters.animationTicks = animation->getTickCount();
+    counters.animationBusyNanoseconds = animation->getBusyNanoseconds();
+    for (const GpuTimer::ScopeStats &pass : gpuTimer->getStats())
+    {
+        if (pass.name == "hud" && pass.gpuSamples > 0)
+            counters.hudGpuMilliseconds = pass.gpuMilliseconds;
     }
+    hud->refresh(counters, *framePacer);
+}
 
-    // Render mesh
-    renderer->renderMesh(currentMesh, model);
+void render(const TransformSnapshot &snapshot)
+{
+    if (!renderer || !gpuTimer || !currentMesh || snapshot.models.empty())
+        return;
+
+    PROFILE_SCOPE("render");
+
+    // Poses for this frame, between the last two animation ticks
+    interpolateSnapshot(snapshot, std::chrono::steady_clock::now(), instanceModels);
+    drawInstances();
+}
 
-    // Performance timing
-    auto renderEnd = std::chrono::high_resolution_clock::now();
-    if (showPerformanceStats)
+// Show a finished frame; offscreen there is nothing to swap, so just submit
+void presentFrame(GLFWwindow *window)
+{
+    if (window)
+        glfwSwapBuffers(window);
+    else
+        glFlush();
+}
+
+// Keep uploading until the requested model replaced the placeholder cube.
+// The window keeps handling events meanwhile; false if it was closed or the
+// model could not be loaded.
+bool waitForModel(GLFWwindow *window)
+{
+    while (meshLoader && meshLoader->isBusy())
+    {
+        if (window)
+        {
+            glfwPollEvents();
+            if (glfwWindowShouldClose(window))
+                return false;
+        }
+
+        if (Mesh *loadedMesh = meshLoader->update())
+        {
+            delete currentMesh;
+            currentMesh = loadedMesh;
+        }
+        presentFrame(window);
+
+        // Parsing runs on the worker; don't spin a core while it does
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (modelLoadFailed || (meshLoader && meshLoader->hasFailed()))
     {
-        auto renderDuration = std::chrono::duration_cast<std::chrono::microseconds>(renderEnd - renderStart);
-        frameTime = renderDuration.count() / 1000.0f; // Convert to milliseconds
+        std::cerr << "Model did not load: " << config.objFilename << std::endl;
+        return false;
     }
+    return true;
 }
 
 bool initializeSystem()
@@ -166,13 +329,19 @@ GLFWwindow *createWindow()
 
 bool setupGraphics()
 {
-    // Initialize GLEW
-    if (glewInit() != GLEW_OK)
+    // Initialize GLEW. A GLX build of GLEW finds no X display under an EGL
+    // context, but has loaded the GL entry points by then.
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && !(headless && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY))
     {
         std::cerr << "Failed to initialize GLEW" << std::endl;
         return false;
     }
 
+    // Offscreen, everything renders into a framebuffer object instead of a window
+    if (headless && !headless->createFramebuffer())
+        return false;
+
     // Initialize renderer with custom shader paths from configuration
     renderer = new Renderer();
 
@@ -180,6 +349,11 @@ bool setupGraphics()
     std::cout << "  Vertex shader: " << config.vertexShaderPath << std::endl;
     std::cout << "  Fragment shader: " << config.fragmentShaderPath << std::endl;
 
+    // Shader setup time is the startup cost the program binary cache removes
+    auto shaderStart = std::chrono::high_resolution_clock::now();
+    if (config.useShaderCache)
+        renderer->setShaderCacheDirectory(config.meshCacheDirectory);
+
     if (!renderer->initializeWithShaderFiles(config.vertexShaderPath, config.fragmentShaderPath))
     {
         std::cerr << "Failed to initialize renderer with shader files:" << std::endl;
@@ -190,6 +364,33 @@ bool setupGraphics()
     }
 
     std::cout << "Successfully initialized renderer with custom shaders" << std::endl;
+    if (headless)
+        renderer->onFramebufferSize(headless->getWidth(), headless->getHeight());
+    renderer->setLodPixelError(config.lodPixelError);
+
+    gpuTimer = new GpuTimer();
+    gpuTimer->create();
+
+    if (config.instanceCount > 1 || config.benchmarkInstances)
+    {
+        renderer->loadInstancedShaders(config.instancedVertexShaderPath, config.fragmentShaderPath);
+    }
+
+    auto shaderTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - shaderStart);
+    std::cout << "Shader setup: " << shaderTime.count() / 1000.0 << "ms"
+              << (config.useShaderCache ? "" : " (binary cache disabled)") << std::endl;
+
+    // Edited shader files are recompiled and swapped in while running
+    if (config.watchShaders && !headless)
+    {
+        shaderWatcher = new ShaderWatcher();
+        std::vector<std::string> shaderPaths = {config.vertexShaderPath, config.fragmentShaderPath};
+        if (config.instanceCount > 1 || config.benchmarkInstances)
+            shaderPaths.push_back(config.instancedVertexShaderPath);
+        if (shaderWatcher->watch(shaderPaths))
+            std::cout << "Watching shader files for changes" << std::endl;
+    }
     return true;
 }
 
@@ -216,14 +417,41 @@ void setupMesh()
 {
     if (!config.objFilename.empty())
     {
-        if (loadMeshFromOBJ(config.objFilename, &currentMesh))
+        MeshLoadOptions options;
+        options.vertexFormat = config.vertexFormat;
+        options.useCache = config.useMeshCache;
+        options.cacheDirectory = config.meshCacheDirectory;
+        options.streaming = config.streamMeshLoading;
+        options.memoryBudget = config.streamMemoryBudget;
+        options.lodRatios = config.lodRatios;
+        options.buildMeshlets = config.buildMeshlets;
+
+        if (config.asyncMeshLoading)
+        {
+            // Keep the default cube on screen until the model is resident
+            currentMesh = createDefaultCube();
+            currentMesh->setVertexFormat(config.vertexFormat);
+            currentMesh->setupBuffers();
+
+            meshLoader = new AsyncMeshLoader(config.uploadBudgetBytes);
+            if (!meshLoader->start(config.objFilename, options))
+            {
+                std::cerr << "Failed to start loading model, using default cube" << std::endl;
+                modelLoadFailed = true;
+                delete meshLoader;
+                meshLoader = nullptr;
+            }
+        }
+        else if (loadMeshFromOBJ(config.objFilename, &currentMesh, options))
         {
             std::cout << "Successfully loaded model: " << config.objFilename << std::endl;
         }
         else
         {
             std::cout << "Failed to load model, using default cube" << std::endl;
+            modelLoadFailed = true;
             currentMesh = createDefaultCube();
+            currentMesh->setVertexFormat(config.vertexFormat);
             currentMesh->setupBuffers();
         }
     }
@@ -231,6 +459,7 @@ void setupMesh()
     {
         std::cout << "Using default cube" << std::endl;
         currentMesh = createDefaultCube();
+        currentMesh->setVertexFormat(config.vertexFormat);
         currentMesh->setupBuffers();
     }
 }
@@ -241,8 +470,13 @@ void printSystemInfo()
     std::cout << "Settings:" << std::endl;
     std::cout << "  Orientation: " << (config.useQuaternions ? "Quaternions" : "Euler Angles") << std::endl;
     std::cout << "  Interpolation: " << (config.useBSpline ? "B-Spline" : "Catmull-Rom") << std::endl;
+    std::cout << "  Vertex Format: " << (config.vertexFormat == VertexFormat::Compact ? "Compact (16 bytes)" : "Float (32 bytes)") << std::endl;
     std::cout << "  Vertex Shader: " << config.vertexShaderPath << std::endl;
     std::cout << "  Fragment Shader: " << config.fragmentShaderPath << std::endl;
+    if (config.instanceCount > 1)
+    {
+        std::cout << "  Instances: " << config.instanceCount << std::endl;
+    }
 
     if (!config.objFilename.empty())
     {
@@ -260,6 +494,9 @@ void printSystemInfo()
     std::cout << "R - Reset animation" << std::endl;
     std::cout << "C - Reset camera" << std::endl;
     std::cout << "P - Toggle performance stats" << std::endl;
+    std::cout << "V - Cycle frame pacing (vsync, adaptive, uncapped, capped)" << std::endl;
+    std::cout << "H - Toggle performance HUD" << std::endl;
+    std::cout << "T - Write a Chrome trace of profiled scopes" << std::endl;
     std::cout << "ESC - Exit" << std::endl;
     std::cout << "\nCamera Controls:" << std::endl;
     std::cout << "Mouse Drag - Rotate camera" << std::endl;
@@ -275,18 +512,61 @@ void printSystemInfo()
 
 void cleanup()
 {
+    if (meshLoader)
+    {
+        delete meshLoader;
+        meshLoader = nullptr;
+    }
+
     if (currentMesh)
     {
         delete currentMesh;
         currentMesh = nullptr;
     }
 
+    if (animation)
+    {
+        delete animation;
+        animation = nullptr;
+    }
+
+    if (framePacer)
+    {
+        delete framePacer;
+        framePacer = nullptr;
+    }
+
+    if (shaderWatcher)
+    {
+        delete shaderWatcher;
+        shaderWatcher = nullptr;
+    }
+
+    if (hud)
+    {
+        delete hud;
+        hud = nullptr;
+    }
+
+    if (gpuTimer)
+    {
+        delete gpuTimer;
+        gpuTimer = nullptr;
+    }
+
     if (renderer)
     {
         delete renderer;
         renderer = nullptr;
     }
 
+    // The context goes last, after everything that owns GL objects
+    if (headless)
+    {
+        delete headless;
+        headless = nullptr;
+    }
+
     if (motionController)
     {
         delete motionController;
@@ -294,24 +574,73 @@ void cleanup()
     }
 }
 
+// Frame time percentiles over the recorded history and hitches since the last report
+static void printFrameReport(const FramePacer::Report &report)
+{
+    LogLine line(LogLevel::Info);
+    std::ostream &out = line.stream();
+    auto print = [&out](const char *name, const FrameTimeHistory::Summary &summary)
+    {
+        out << " | " << name << " ";
+        if (summary.samples == 0)
+        {
+            out << "n/a";
+            return;
+        }
+        out << summary.p50 << "/" << summary.p95 << "/" << summary.p99 << "/" << summary.max;
+    };
+
+    out << "  Frames (" << pacingModeName(framePacer->getMode()) << ", last " << report.interval.samples
+        << ") ms p50/p95/p99/max:" << std::fixed << std::setprecision(2);
+    print("interval", report.interval);
+    print("CPU", report.cpu);
+    print("GPU", report.gpu);
+    out << " | " << report.hitches << " hitches in " << report.frames << " frames";
+}
+
 void mainLoop(GLFWwindow *window)
 {
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
 
+    if (!motionController || !currentMesh)
+        return;
+
+    // Animation is evaluated on its own thread; this one polls events and renders
+    animation = new AnimationThread();
+    animation->setInterpolation(useQuaternions, useBSpline);
+    animation->start(motionController, config.instanceCount, instanceSpacing(), config.tickRate, config.playbackRate);
+
+    framePacer = new FramePacer();
+    framePacer->setMode(config.pacingMode, config.frameRateCap);
+    float frameReportTimer = 0.0f;
+
+    // Records frame times even while hidden, so toggling it on shows history
+    hud = new HudOverlay();
+    if (!hud->create())
+    {
+        delete hud;
+        hud = nullptr;
+    }
+    showHud = config.showHud;
+
+    // Render thread stage timings over the current stats interval
+    double renderMilliseconds = 0.0;
+    double swapMilliseconds = 0.0;
+    double snapshotAgeMilliseconds = 0.0;
+    int repeatedSnapshots = 0;
+
     while (!glfwWindowShouldClose(window))
     {
+        // Sleeps only when a frame rate cap is set
+        framePacer->waitForFrame();
+        PROFILE_SCOPE("frame");
+        auto workStart = std::chrono::steady_clock::now();
+
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // Update animation time with fixed speed
-        currentTime += deltaTime * 0.5f; // Fixed animation speed
-        if (motionController && currentTime > motionController->getTotalTime())
-        {
-            currentTime = 0.0f; // Loop animation
-        }
-
         // Update performance stats
         if (showPerformanceStats)
         {
@@ -320,26 +649,521 @@ void mainLoop(GLFWwindow *window)
             if (fpsTimer >= 1.0f)
             {
                 averageFPS = frameCount / fpsTimer;
-                std::cout << "FPS: " << std::fixed << std::setprecision(1) << averageFPS
-                          << " | Frame time: " << std::setprecision(2) << frameTime << "ms" << std::endl;
+                {
+                    LogLine line(LogLevel::Info);
+                    line.stream() << "FPS: " << std::fixed << std::setprecision(1) << averageFPS
+                                  << " | LOD: " << renderer->getLastLod()
+                                  << " | Ring stalls: " << renderer->getRingStallCount();
+                    const GLStateCache::Stats &glStats = renderer->getFrameStats();
+                    line.stream() << " | Draws: " << glStats.drawCalls << " | State changes: "
+                                  << glStats.stateChanges << " (" << glStats.redundantChanges << " skipped)";
+                    const MeshletCullStats &cull = renderer->getCullStats();
+                    if (cull.total > 0)
+                    {
+                        line.stream() << " | Meshlets culled: " << std::setprecision(1)
+                                      << 100.0f * (cull.frustumCulled + cull.backfaceCulled) / cull.total << "% ("
+                                      << cull.frustumCulled << " frustum, " << cull.backfaceCulled << " backface, "
+                                      << cull.drawRanges << " ranges)";
+                    }
+                }
+                printFrameReport(framePacer->report());
+                frameReportTimer = 0.0f;
+
+                // Per-pass averages since the last report, CPU submission next to GPU execution
+                {
+                    LogLine line(LogLevel::Info);
+                    line.stream() << "  Pass ms (CPU/GPU):" << std::fixed << std::setprecision(3);
+                    for (const GpuTimer::ScopeStats &pass : gpuTimer->getStats())
+                    {
+                        line.stream() << " " << pass.name << " " << pass.cpuMilliseconds << "/";
+                        if (pass.gpuSamples > 0)
+                            line.stream() << pass.gpuMilliseconds;
+                        else
+                            line.stream() << "n/a";
+                    }
+                    if (gpuTimer->getDroppedFrames() > 0)
+                        line.stream() << " | " << gpuTimer->getDroppedFrames() << " frames without GPU results";
+                }
+                gpuTimer->resetStats();
+
+                // Thread utilization: animation ticks vs render frames and where each spends its time
+                AnimationThread::Stats animationStats = animation->collectStats();
+                LOG_INFO("  Threads: animation " << std::fixed << std::setprecision(3)
+                                                 << animationStats.ticks / fpsTimer << " ticks/s ("
+                                                 << animationStats.skippedTicks << " skipped), "
+                                                 << animationStats.evaluateMilliseconds << "ms/tick, "
+                                                 << std::setprecision(1) << 100.0 * animationStats.busyFraction
+                                                 << "% busy | render " << std::setprecision(3)
+                                                 << renderMilliseconds / frameCount << "ms/frame + swap "
+                                                 << swapMilliseconds / frameCount << "ms, " << std::setprecision(1)
+                                                 << 100.0 * renderMilliseconds / (fpsTimer * 1000.0)
+                                                 << "% busy | snapshot age " << std::setprecision(2)
+                                                 << snapshotAgeMilliseconds / frameCount << "ms, "
+                                                 << repeatedSnapshots << " frames reused a snapshot");
+                renderMilliseconds = swapMilliseconds = snapshotAgeMilliseconds = 0.0;
+                repeatedSnapshots = 0;
+
                 frameCount = 0;
                 fpsTimer = 0.0f;
             }
         }
+        else if (config.frameReportInterval > 0.0f)
+        {
+            // Low-rate report meant to stay on; recording itself costs a few stores per frame
+            frameReportTimer += deltaTime;
+            if (frameReportTimer >= config.frameReportInterval)
+            {
+                printFrameReport(framePacer->report());
+                frameReportTimer = 0.0f;
+            }
+        }
 
         // Poll events
         glfwPollEvents();
 
+        if (shaderWatcher && shaderWatcher->poll())
+            renderer->reloadShaders();
+
+        // Continue any background model upload and swap it in once resident
+        if (meshLoader)
+        {
+            if (Mesh *loadedMesh = meshLoader->update())
+            {
+                delete currentMesh;
+                currentMesh = loadedMesh;
+                animation->setInstanceSpacing(instanceSpacing());
+                LOG_INFO("Successfully loaded model: " << config.objFilename);
+            }
+        }
+
+        // Pick up the newest finished snapshot without waiting for the animation thread
+        auto frameStart = std::chrono::steady_clock::now();
+        bool freshSnapshot = animation->update();
+        const TransformSnapshot &snapshot = animation->getSnapshot();
+
+        if (hud && showHud && hud->needsRefresh())
+            refreshHud();
+
         // Render
-        render();
+        render(snapshot);
+        auto renderEnd = std::chrono::steady_clock::now();
 
         // Swap buffers
-        glfwSwapBuffers(window);
+        {
+            PROFILE_SCOPE("swap");
+            glfwSwapBuffers(window);
+        }
+
+        double cpuMilliseconds = std::chrono::duration<double, std::milli>(renderEnd - workStart).count();
+        framePacer->endFrame(cpuMilliseconds);
+        if (hud)
+            hud->endFrame();
+        double gpuMilliseconds = 0.0;
+        if (gpuTimer->takeFrameGpuTime(gpuMilliseconds))
+            framePacer->addGpuTime(gpuMilliseconds);
+
+        if (showPerformanceStats)
+        {
+            repeatedSnapshots += !freshSnapshot;
+            snapshotAgeMilliseconds += std::chrono::duration<double, std::milli>(frameStart - snapshot.published).count();
+            renderMilliseconds += std::chrono::duration<double, std::milli>(renderEnd - frameStart).count();
+            swapMilliseconds +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderEnd).count();
+        }
+    }
+
+    animation->stop();
+}
+
+// Render a fixed number of frames offscreen. Frame i shows the animation at
+// tick i, so the output does not depend on how fast the machine renders.
+// Returns false if the requested model did not load.
+bool runHeadless()
+{
+    if (!waitForModel(nullptr))
+        return false;
+
+    std::cout << "\nRendering " << config.headlessFrames << " frames offscreen at " << headless->getWidth() << "x"
+              << headless->getHeight() << std::endl;
+
+    FrameTimeHistory frameTimes;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < config.headlessFrames; frame++)
+    {
+        auto frameStart = std::chrono::steady_clock::now();
+        double time = std::fmod(frame * config.playbackRate / config.tickRate, motionController->getTotalTime());
+        computeInstanceModels(config.instanceCount, static_cast<float>(time));
+        drawInstances();
+        presentFrame(nullptr);
+        frameTimes.add(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+    glFinish();
+
+    double totalMilliseconds =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    FrameTimeHistory::Summary summary = frameTimes.summarize();
+    std::cout << "Headless: " << config.headlessFrames << " frames in " << std::fixed << std::setprecision(1)
+              << totalMilliseconds << "ms (" << config.headlessFrames * 1000.0 / std::max(totalMilliseconds, 0.001)
+              << " fps) | CPU ms p50/p95/p99/max: " << std::setprecision(2) << summary.p50 << "/" << summary.p95
+              << "/" << summary.p99 << "/" << summary.max << std::endl;
+
+    std::cout << "  Pass ms (CPU/GPU):";
+    for (const GpuTimer::ScopeStats &pass : gpuTimer->getStats())
+    {
+        std::cout << " " << pass.name << " " << std::setprecision(3) << pass.cpuMilliseconds << "/";
+        if (pass.gpuSamples > 0)
+            std::cout << pass.gpuMilliseconds;
+        else
+            std::cout << "n/a";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+// Scripted, reproducible measurement: every orientation x interpolation mode
+// renders config.benchmarkFrames frames at fixed animation time steps while the
+// camera makes one full orbit. Results are written as JSON and, given a
+// baseline, checked for regressions. Returns false on failure or regression,
+// including a requested model that did not load.
+bool runBenchmark(GLFWwindow *window)
+{
+    const int WARMUP_FRAMES = 10;
+
+    if (!waitForModel(window))
+        return false;
+    if (window)
+        glfwSwapInterval(0);
+
+    BenchmarkResults results;
+    results.model = config.objFilename.empty() ? "cube" : config.objFilename;
+    results.keyframes = config.keyframesProvided ? config.keyframeString : "default";
+    results.renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+    results.instances = config.instanceCount;
+    results.frames = config.benchmarkFrames;
+    if (headless)
+    {
+        results.width = headless->getWidth();
+        results.height = headless->getHeight();
+    }
+    else
+    {
+        glfwGetFramebufferSize(window, &results.width, &results.height);
+    }
+
+    // Far enough out to keep the whole instance grid in view
+    float gridExtent = instanceSpacing() * std::ceil(std::sqrt(static_cast<float>(config.instanceCount)));
+    float orbitDistance = std::min(std::max({8.0f, currentMesh->getBoundingRadius() * 4.0f, gridExtent * 1.5f}), 50.0f);
+
+    // GPU results still in flight belong to the previous frames; collect or drop them
+    auto drainGpuTimes = [](std::vector<float> *samples)
+    {
+        glFinish();
+        for (int i = 0; i < GpuTimer::FRAME_LATENCY; i++)
+        {
+            gpuTimer->beginFrame();
+            gpuTimer->endFrame();
+            double milliseconds = 0.0;
+            if (gpuTimer->takeFrameGpuTime(milliseconds) && samples)
+                samples->push_back(static_cast<float>(milliseconds));
+        }
+    };
+
+    std::cout << "\nBenchmark: " << config.benchmarkFrames << " frames per mode, " << results.width << "x"
+              << results.height << ", " << results.renderer << std::endl;
+
+    bool savedQuaternions = useQuaternions;
+    bool savedBSpline = useBSpline;
+    for (int mode = 0; mode < 4; mode++)
+    {
+        useQuaternions = mode < 2;
+        useBSpline = mode % 2 == 1;
+
+        BenchmarkCase entry;
+        entry.name = std::string(useQuaternions ? "quat" : "euler") + "-" + (useBSpline ? "bspline" : "catmullrom");
+        std::vector<float> cpuTimes, gpuTimes, evaluateTimes;
+
+        for (int frame = -WARMUP_FRAMES; frame < static_cast<int>(config.benchmarkFrames); frame++)
+        {
+            if (frame == 0)
+                drainGpuTimes(nullptr);
+
+            size_t step = std::max(frame, 0);
+            auto frameStart = std::chrono::steady_clock::now();
+            renderer->setCameraOrbit(45.0f + 360.0f * step / config.benchmarkFrames, 35.0f, orbitDistance);
+            double time = std::fmod(step * config.playbackRate / config.tickRate, motionController->getTotalTime());
+            computeInstanceModels(config.instanceCount, static_cast<float>(time));
+            auto evaluateEnd = std::chrono::steady_clock::now();
+            drawInstances();
+            presentFrame(window);
+            auto frameEnd = std::chrono::steady_clock::now();
+
+            if (frame < 0)
+                continue;
+            cpuTimes.push_back(std::chrono::duration<float, std::milli>(frameEnd - frameStart).count());
+            evaluateTimes.push_back(std::chrono::duration<float, std::milli>(evaluateEnd - frameStart).count());
+            const GLStateCache::Stats &glStats = renderer->getFrameStats();
+            entry.drawCalls += glStats.drawCalls;
+            entry.stateChanges += glStats.stateChanges;
+            double gpuMilliseconds = 0.0;
+            if (gpuTimer->takeFrameGpuTime(gpuMilliseconds))
+                gpuTimes.push_back(static_cast<float>(gpuMilliseconds));
+        }
+        drainGpuTimes(&gpuTimes);
+
+        entry.cpuMilliseconds = FrameTimeHistory::summarize(cpuTimes);
+        entry.gpuMilliseconds = FrameTimeHistory::summarize(gpuTimes);
+        entry.evaluateMilliseconds = FrameTimeHistory::summarize(evaluateTimes);
+        entry.drawCalls /= std::max<size_t>(config.benchmarkFrames, 1);
+        entry.stateChanges /= std::max<size_t>(config.benchmarkFrames, 1);
+        results.cases.push_back(entry);
+
+        std::cout << "  " << std::left << std::setw(18) << entry.name << std::right << std::fixed
+                  << std::setprecision(3) << "cpu p50/p95/p99 " << entry.cpuMilliseconds.p50 << "/"
+                  << entry.cpuMilliseconds.p95 << "/" << entry.cpuMilliseconds.p99 << "ms | gpu p50/p95 ";
+        if (entry.gpuMilliseconds.samples > 0)
+            std::cout << entry.gpuMilliseconds.p50 << "/" << entry.gpuMilliseconds.p95 << "ms";
+        else
+            std::cout << "n/a";
+        std::cout << " | evaluate p50 " << entry.evaluateMilliseconds.p50 << "ms | " << std::setprecision(1)
+                  << entry.drawCalls << " draws" << std::endl;
+    }
+    useQuaternions = savedQuaternions;
+    useBSpline = savedBSpline;
+
+    results.peakRSSBytes = getPeakRSSBytes();
+    if (!writeBenchmarkResults(results, config.benchmarkOutput))
+        return false;
+    std::cout << "Benchmark results written to " << config.benchmarkOutput << std::endl;
+
+    if (config.benchmarkBaseline.empty())
+        return true;
+
+    BenchmarkResults baseline;
+    if (!readBenchmarkResults(config.benchmarkBaseline, baseline))
+        return false;
+    return compareBenchmarkResults(results, baseline, config.benchmarkThreshold) == 0;
+}
+
+// Render the motion controller's whole time range at config.exportFps and
+// write every frame out. The same frames are rendered once without readback
+// first, so the export rate can be compared with pure render throughput.
+// Returns false if the requested model did not load, the export could not
+// start or any frame failed to write.
+bool runExport(GLFWwindow *window)
+{
+    if (!waitForModel(window))
+        return false;
+    if (window)
+        glfwSwapInterval(0);
+
+    int width = 0, height = 0;
+    if (headless)
+    {
+        width = headless->getWidth();
+        height = headless->getHeight();
+    }
+    else
+    {
+        glfwGetFramebufferSize(window, &width, &height);
+    }
+
+    size_t frameCount =
+        std::max<size_t>(1, static_cast<size_t>(std::ceil(motionController->getTotalTime() * config.exportFps)));
+    std::cout << "\nExporting " << frameCount << " frames (" << motionController->getTotalTime() << "s at "
+              << config.exportFps << " fps, " << width << "x" << height << ") to "
+              << (config.exportOptions.pipeCommand.empty() ? config.exportOptions.directory
+                                                            : config.exportOptions.pipeCommand)
+              << std::endl;
+
+    FrameExporter exporter;
+    bool written = false;
+    double seconds[2] = {0.0, 0.0};
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool exporting = pass == 1;
+        if (exporting && !exporter.start(width, height, config.exportOptions))
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t frame = 0; frame < frameCount; frame++)
+        {
+            computeInstanceModels(config.instanceCount, static_cast<float>(frame / config.exportFps));
+            drawInstances();
+            if (exporting)
+                exporter.capture(frame);
+            presentFrame(window);
+        }
+        if (exporting)
+            written = exporter.finish();
+        else
+            glFinish();
+        seconds[pass] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const FrameExporter::Stats &stats = exporter.getStats();
+    double renderFps = frameCount / std::max(seconds[0], 1e-6);
+    double exportFps = frameCount / std::max(seconds[1], 1e-6);
+    std::cout << "Export: " << stats.frames << " frames at " << std::fixed << std::setprecision(1) << exportFps
+              << " fps sustained, render only " << renderFps << " fps (" << 100.0 * exportFps / renderFps
+              << "%) | render thread waited " << stats.fenceWaitMilliseconds << "ms on readbacks, "
+              << stats.queueWaitMilliseconds << "ms on writers";
+    if (stats.writeErrors > 0)
+        std::cout << " | " << stats.writeErrors << " frames failed";
+    std::cout << std::endl;
+    return written && stats.writeErrors == 0;
+}
+
+// Draw 1..100k animated instances, one draw per object vs one instanced draw.
+// Returns false if the model did not load or the instance ring could not be mapped.
+bool runInstanceBenchmark(GLFWwindow *window)
+{
+    const int FRAMES = 30;
+    const size_t counts[] = {1, 10, 100, 1000, 10000, 100000};
+
+    // Benchmark the requested model, not the placeholder cube
+    if (!waitForModel(window))
+        return false;
+
+    if (window)
+        glfwSwapInterval(0);
+    std::cout << "\nInstance benchmark (" << FRAMES << " frames each, mesh " << currentMesh->getVertexCount()
+              << " vertices)" << std::endl;
+    std::cout << std::setw(10) << "instances" << std::setw(16) << "per-object ms" << std::setw(16) << "instanced ms"
+              << std::setw(12) << "speedup" << std::endl;
+
+    for (size_t count : counts)
+    {
+        double frameMs[2];
+        for (int instanced = 0; instanced < 2; instanced++)
+        {
+            // Both paths evaluate the animation every frame; the instanced one
+            // writes it straight into the mapped instance ring
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int frame = 0; frame < FRAMES; frame++)
+            {
+                float time = frame / 60.0f;
+                renderer->clear();
+                renderer->beginFrame();
+                if (instanced)
+                {
+                    // Timing empty frames would report a bogus speedup
+                    if (!writeInstances(count, time))
+                    {
+                        renderer->endFrame();
+                        std::cerr << "Failed to map " << count << " instances" << std::endl;
+                        return false;
+                    }
+                    renderer->drawInstances(currentMesh, count);
+                }
+                else
+                {
+                    computeInstanceModels(count, time);
+                    for (size_t i = 0; i < count; i++)
+                        renderer->renderMesh(currentMesh, instanceModels[i], true);
+                }
+                renderer->endFrame();
+                presentFrame(window);
+            }
+            glFinish();
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - start);
+            frameMs[instanced] = elapsed.count() / 1000.0 / FRAMES;
+        }
+
+        std::cout << std::setw(10) << count << std::fixed << std::setprecision(3) << std::setw(16) << frameMs[0]
+                  << std::setw(16) << frameMs[1] << std::setprecision(1) << std::setw(11)
+                  << frameMs[0] / std::max(frameMs[1], 0.001) << "x" << std::endl;
+    }
+
+    std::cout << "Ring buffer stalls: " << renderer->getRingStallCount() << " (" << std::setprecision(2)
+              << renderer->getRingStallMilliseconds() << "ms waiting)" << std::endl;
+    return true;
+}
+
+// Vertex-bound comparison of the per-vertex normal matrix inverse against
+// the normal matrix computed on the CPU (an instance attribute here).
+// Returns false if the model is unsuitable or a variant fails to build.
+bool runVertexShaderBenchmark(GLFWwindow *window)
+{
+    const int FRAMES = 60;
+    const size_t TARGET_VERTICES = 50000000;
+    const size_t MAX_INSTANCES = 4096;
+
+    if (!waitForModel(window))
+        return false;
+
+    // One instanced draw of enough copies to push ~50M vertices per frame
+    // through a tiny viewport, so vertex shading dominates. A small model would
+    // need so many copies that writing their instance records would dominate.
+    size_t vertexCount = std::max<size_t>(currentMesh->getVertexCount(), 1);
+    size_t instanceCount = (TARGET_VERTICES + vertexCount - 1) / vertexCount;
+    if (instanceCount > MAX_INSTANCES)
+    {
+        std::cerr << "Vertex shader benchmark needs a model with at least "
+                  << (TARGET_VERTICES + MAX_INSTANCES - 1) / MAX_INSTANCES << " vertices (-m); this one has "
+                  << vertexCount << std::endl;
+        return false;
+    }
+    std::vector<glm::mat4> models(instanceCount);
+
+    if (window)
+        glfwSwapInterval(0);
+    glViewport(0, 0, 64, 64);
+
+    const char *variants[2] = {"#define PER_VERTEX_NORMAL_MATRIX\n", ""};
+    const char *names[2] = {"per-vertex inverse(model)", "CPU normal matrix"};
+    double frameMs[2] = {0.0, 0.0};
+
+    std::cout << "\nVertex shader benchmark: " << vertexCount << " vertices x " << instanceCount
+              << " instances in one draw per frame, " << FRAMES << " frames" << std::endl;
+
+    for (int variant = 0; variant < 2; variant++)
+    {
+        Renderer variantRenderer;
+        if (!variantRenderer.initializeWithShaderFiles(config.vertexShaderPath, config.fragmentShaderPath,
+                                                       variants[variant]) ||
+            !variantRenderer.loadInstancedShaders(config.instancedVertexShaderPath, config.fragmentShaderPath))
+        {
+            std::cerr << "Failed to build shader variant: " << names[variant] << std::endl;
+            return false;
+        }
+        variantRenderer.onFramebufferSize(64, 64);
+
+        for (int frame = -5; frame < FRAMES; frame++)
+        {
+            // The first frames warm up the driver and are not timed
+            if (frame == 0)
+                glFinish();
+            auto start = std::chrono::high_resolution_clock::now();
+
+            variantRenderer.clear();
+            variantRenderer.beginFrame();
+            glm::mat4 model = motionController->getTransformationMatrix(frame / 60.0f, useQuaternions, useBSpline);
+            std::fill(models.begin(), models.end(), model);
+            variantRenderer.renderInstanced(currentMesh, models.data(), instanceCount, true);
+            variantRenderer.endFrame();
+            glFinish();
+
+            if (frame >= 0)
+            {
+                frameMs[variant] += std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count() / FRAMES;
+            }
+            presentFrame(window);
+        }
+
+        std::cout << "  " << std::left << std::setw(28) << names[variant] << std::right << std::fixed
+                  << std::setprecision(3) << frameMs[variant] << " ms/frame" << std::endl;
     }
+
+    std::cout << "  Speedup: " << std::setprecision(2) << frameMs[0] / std::max(frameMs[1], 0.001) << "x" << std::endl;
+    return true;
 }
 
 int main(int argc, char *argv[])
 {
+    PROFILE_THREAD("main");
+
     // Parse command line arguments
     if (!parseCommandLine(argc, argv, config))
     {
@@ -353,28 +1177,47 @@ int main(int argc, char *argv[])
     }
 
     // Apply configuration
+    Logger::setLevel(config.logLevel);
     useQuaternions = config.useQuaternions;
     useBSpline = config.useBSpline;
 
-    // Initialize systems
-    if (!initializeSystem())
+    // Initialize systems; headless runs never touch GLFW and need no display
+    GLFWwindow *window = nullptr;
+    if (config.headless)
     {
-        return -1;
+        headless = new HeadlessContext();
+        if (!headless->create(config.headlessWidth, config.headlessHeight))
+        {
+            delete headless;
+            headless = nullptr;
+            return -1;
+        }
     }
-
-    // Create window
-    GLFWwindow *window = createWindow();
-    if (!window)
+    else
     {
-        glfwTerminate();
-        return -1;
+        if (!initializeSystem())
+        {
+            return -1;
+        }
+
+        // Create window
+        window = createWindow();
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
     }
 
     // Setup graphics (this now uses the shader paths from config)
     if (!setupGraphics())
     {
-        glfwDestroyWindow(window);
-        glfwTerminate();
+        cleanup();
+        if (window)
+        {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+        }
         return -1;
     }
 
@@ -386,12 +1229,51 @@ int main(int argc, char *argv[])
     printSystemInfo();
 
     // Main application loop
-    mainLoop(window);
+    int exitCode = 0;
+    if (config.benchmarkFrames > 0)
+    {
+        if (!runBenchmark(window))
+            exitCode = 1;
+    }
+    else if (config.benchmarkInstances)
+    {
+        if (!runInstanceBenchmark(window))
+            exitCode = 1;
+    }
+    else if (config.benchmarkVertexShader)
+    {
+        if (!runVertexShaderBenchmark(window))
+            exitCode = 1;
+    }
+    else if (config.exportFrames)
+    {
+        if (!runExport(window))
+            exitCode = 1;
+    }
+    else if (headless)
+    {
+        if (!runHeadless())
+            exitCode = 1;
+    }
+    else
+    {
+        // While frames run, console output goes through the logger's writer thread
+        Logger::start();
+        mainLoop(window);
+        Logger::stop();
+    }
 
     // Cleanup
     cleanup();
-    glfwDestroyWindow(window);
-    glfwTerminate();
+    if (window)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    // Worker threads have stopped, so every ring is complete
+    if (!config.tracePath.empty())
+        Profiler::writeChromeTrace(config.tracePath);
 
-    return 0;
+    return exitCode;
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "motion/AnimationThread.h"
+#include "motion/Profiler.h"
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <cmath>
+
+glm::mat4 instanceTransform(const OptimizedMotionController &controller, size_t index, size_t count, float spacing,
+                            float time, bool useQuaternions, bool useBSpline)
+{
+    if (count == 1)
+        return controller.getTransformationMatrix(time, useQuaternions, useBSpline);
+
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+    glm::vec3 cell((static_cast<float>(index % side) - side * 0.5f) * spacing, 0.0f,
+                   (static_cast<float>(index / side) - side * 0.5f) * spacing);
+    float instanceTime = std::fmod(time + index * 0.37f, controller.getTotalTime());
+    return glm::translate(glm::mat4(1.0f), cell) *
+           controller.getTransformationMatrix(instanceTime, useQuaternions, useBSpline);
+}
+
+void interpolateSnapshot(const TransformSnapshot &snapshot, std::chrono::steady_clock::time_point now,
+                         std::vector<glm::mat4> &models)
+{
+    models.resize(snapshot.models.size());
+    float alpha = std::chrono::duration<float>(now - snapshot.tickTime).count() /
+                  std::chrono::duration<float>(snapshot.tickPeriod).count();
+    if (snapshot.discontinuity || snapshot.previousModels.size() != snapshot.models.size() || !(alpha < 1.0f))
+    {
+        std::copy(snapshot.models.begin(), snapshot.models.end(), models.begin());
+        return;
+    }
+    alpha = std::max(alpha, 0.0f);
+
+    for (size_t i = 0; i < models.size(); i++)
+    {
+        const glm::mat4 &from = snapshot.previousModels[i];
+        const glm::mat4 &to = snapshot.models[i];
+        glm::quat rotation = glm::slerp(glm::quat_cast(glm::mat3(from)), glm::quat_cast(glm::mat3(to)), alpha);
+        glm::mat4 model = glm::mat4_cast(rotation);
+        model[3] = glm::vec4(glm::mix(glm::vec3(from[3]), glm::vec3(to[3]), alpha), 1.0f);
+        models[i] = model;
+    }
+}
+
+AnimationThread::AnimationThread()
+    : controller(nullptr), instanceCount(1), tickPeriod(0), tickTimeStep(0.0f), running(false),
+      useQuaternions(true), useBSpline(false), instanceSpacing(1.0f), resetRequested(false), lastTick(0),
+      resetTick(0), tickCount(0), skippedTickCount(0), busyNanoseconds(0), statsTicks(0), statsSkippedTicks(0),
+      statsBusyNanoseconds(0)
+{
+}
+
+AnimationThread::~AnimationThread()
+{
+    stop();
+}
+
+void AnimationThread::start(const OptimizedMotionController *motionController, size_t count, float spacing,
+                            double tickRate, float playbackRate)
+{
+    stop();
+
+    controller = motionController;
+    instanceCount = std::max<size_t>(count, 1);
+    instanceSpacing = spacing;
+    tickPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / tickRate));
+    tickTimeStep = static_cast<float>(playbackRate / tickRate);
+
+    startTime = Clock::now();
+    lastTick = 0;
+    resetTick = 0;
+    lastModels.clear();
+    publish(0, true);
+    snapshots.update();
+
+    statsStart = Clock::now();
+    running = true;
+    thread = std::thread(&AnimationThread::run, this);
+}
+
+void AnimationThread::stop()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+void AnimationThread::setInterpolation(bool quaternions, bool bSpline)
+{
+    useQuaternions = quaternions;
+    useBSpline = bSpline;
+}
+
+float AnimationThread::timeAtTick(uint64_t tick) const
+{
+    // Computed from the tick number, not accumulated, so no drift builds up
+    double time = static_cast<double>(tick - resetTick) * tickTimeStep;
+    return static_cast<float>(std::fmod(time, static_cast<double>(controller->getTotalTime())));
+}
+
+void AnimationThread::evaluate(uint64_t tick, std::vector<glm::mat4> &models)
+{
+    bool quaternions = useQuaternions;
+    bool bSpline = useBSpline;
+    float spacing = instanceSpacing;
+    float time = timeAtTick(tick);
+
+    models.resize(instanceCount);
+    for (size_t i = 0; i < instanceCount; i++)
+        models[i] = instanceTransform(*controller, i, instanceCount, spacing, time, quaternions, bSpline);
+}
+
+void AnimationThread::publish(uint64_t tick, bool reset)
+{
+    PROFILE_SCOPE("animation tick");
+    TransformSnapshot &snapshot = snapshots.writeSlot();
+
+    // The previous pose is normally the one published last; after skipped
+    // ticks it is evaluated again so the pair stays one tick apart
+    snapshot.discontinuity = reset || tick == resetTick;
+    if (!snapshot.discontinuity)
+    {
+        if (tick == lastTick + 1 && lastModels.size() == instanceCount)
+            snapshot.previousModels.swap(lastModels);
+        else
+            evaluate(tick - 1, snapshot.previousModels);
+        snapshot.discontinuity = timeAtTick(tick) < timeAtTick(tick - 1); // Looped
+    }
+
+    evaluate(tick, snapshot.models);
+    lastModels = snapshot.models;
+    lastTick = tick;
+
+    snapshot.time = timeAtTick(tick);
+    snapshot.tick = tick;
+    snapshot.tickTime = startTime + tick * tickPeriod;
+    snapshot.tickPeriod = tickPeriod;
+    snapshot.published = Clock::now();
+    snapshots.publish();
+}
+
+void AnimationThread::run()
+{
+    PROFILE_THREAD("animation");
+    while (running)
+    {
+        Clock::time_point now = Clock::now();
+        uint64_t tick = static_cast<uint64_t>((now - startTime) / tickPeriod);
+
+        if (tick > lastTick)
+        {
+            skippedTickCount += tick - lastTick - 1;
+            bool reset = resetRequested.exchange(false);
+            if (reset)
+                resetTick = tick;
+
+            publish(tick, reset);
+
+            busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - now).count();
+            tickCount++;
+        }
+
+        std::this_thread::sleep_until(startTime + (tick + 1) * tickPeriod);
+    }
+}
+
+AnimationThread::Stats AnimationThread::collectStats()
+{
+    Clock::time_point now = Clock::now();
+    double wallNanoseconds = std::chrono::duration<double, std::nano>(now - statsStart).count();
+    statsStart = now;
+
+    uint64_t ticks = tickCount, skippedTicks = skippedTickCount, busyTotal = busyNanoseconds;
+    Stats stats;
+    stats.ticks = ticks - statsTicks;
+    stats.skippedTicks = skippedTicks - statsSkippedTicks;
+    double busy = static_cast<double>(busyTotal - statsBusyNanoseconds);
+    statsTicks = ticks;
+    statsSkippedTicks = skippedTicks;
+    statsBusyNanoseconds = busyTotal;
+    if (stats.ticks > 0)
+        stats.evaluateMilliseconds = busy / 1e6 / stats.ticks;
+    if (wallNanoseconds > 0.0)
+        stats.busyFraction = busy / wallNanoseconds;
+    return stats;
+}
@@ -0,0 +1,256 @@
+#include "motion/AsyncMeshLoader.h"
+#include "motion/Logger.h"
+#include "motion/Profiler.h"
+#include <algorithm>
+#include <cstring>
+
+AsyncMeshLoader::AsyncMeshLoader(size_t frameBudgetBytes)
+    : state(State::Idle)
+    , uploadFrames(0)
+    , workerDone(false)
+    , workerSucceeded(false)
+    , frameBudget(std::max<size_t>(frameBudgetBytes, 4096))
+    , pendingMesh(nullptr)
+    , vertexSource(nullptr)
+    , indexSource(nullptr)
+    , vertexBytes(0)
+    , indexBytes(0)
+    , vertexBytesUploaded(0)
+    , indexBytesUploaded(0)
+    , stagingBuffer(0)
+    , stagingMemory(nullptr)
+    , stagingRegion(0)
+{
+    for (int i = 0; i < STAGING_REGIONS; i++)
+        stagingFences[i] = 0;
+}
+
+AsyncMeshLoader::~AsyncMeshLoader()
+{
+    if (worker.joinable())
+        worker.join();
+
+    delete pendingMesh;
+    destroyStagingBuffer();
+}
+
+bool AsyncMeshLoader::start(const std::string &path, const MeshLoadOptions &options)
+{
+    if (isBusy())
+    {
+        LOG_ERROR("Mesh load already in progress: " << filename);
+        return false;
+    }
+
+    if (worker.joinable())
+        worker.join();
+
+    filename = path;
+    startTime = std::chrono::high_resolution_clock::now();
+    uploadFrames = 0;
+    workerDone = false;
+    workerSucceeded = false;
+    releaseSources();
+    state = State::Loading;
+
+    // File I/O, parsing and packing all happen off the render thread
+    worker = std::thread([this, path, options]()
+    {
+        PROFILE_THREAD("mesh loader");
+        workerSucceeded = loadMeshData(path, options, data, &mapped);
+        workerDone.store(true, std::memory_order_release);
+    });
+
+    LOG_INFO("Loading model in background: " << path);
+    return true;
+}
+
+void AsyncMeshLoader::releaseSources()
+{
+    data = MeshData();
+    mapped.file.close();
+    mapped.layout = MeshData();
+    mapped.vertexData = nullptr;
+    mapped.indexData = nullptr;
+    mapped.indexCount = 0;
+    vertexSource = indexSource = nullptr;
+    vertexBytes = indexBytes = 0;
+}
+
+void AsyncMeshLoader::createStagingBuffer()
+{
+    if (stagingBuffer != 0 || !(GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage))
+        return;
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr size = static_cast<GLsizeiptr>(frameBudget * STAGING_REGIONS);
+
+    glGenBuffers(1, &stagingBuffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, stagingBuffer);
+    glBufferStorage(GL_COPY_READ_BUFFER, size, NULL, flags);
+    stagingMemory = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    if (!stagingMemory)
+    {
+        LOG_WARNING("WARNING: Persistent staging map failed, using glBufferSubData uploads");
+        glDeleteBuffers(1, &stagingBuffer);
+        stagingBuffer = 0;
+    }
+}
+
+void AsyncMeshLoader::destroyStagingBuffer()
+{
+    for (int i = 0; i < STAGING_REGIONS; i++)
+    {
+        if (stagingFences[i])
+        {
+            glDeleteSync(stagingFences[i]);
+            stagingFences[i] = 0;
+        }
+    }
+
+    if (stagingBuffer != 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, stagingBuffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &stagingBuffer);
+        stagingBuffer = 0;
+        stagingMemory = nullptr;
+    }
+}
+
+bool AsyncMeshLoader::uploadNextChunks()
+{
+    size_t offsetInRegion = 0;
+    unsigned char *region = nullptr;
+
+    if (stagingMemory)
+    {
+        // Skip this frame rather than wait if the GPU still reads the region
+        GLsync &fence = stagingFences[stagingRegion];
+        if (fence)
+        {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                return false;
+            glDeleteSync(fence);
+            fence = 0;
+        }
+        region = stagingMemory + stagingRegion * frameBudget;
+        glBindBuffer(GL_COPY_READ_BUFFER, stagingBuffer);
+    }
+
+    struct Stream
+    {
+        const unsigned char *source;
+        size_t totalBytes;
+        size_t *uploaded;
+        unsigned int buffer;
+    };
+    Stream streams[2] = {
+        {vertexSource, vertexBytes, &vertexBytesUploaded, pendingMesh->getVertexBuffer()},
+        {indexSource, indexBytes, &indexBytesUploaded, pendingMesh->getIndexBuffer()},
+    };
+
+    size_t budget = frameBudget;
+    for (const Stream &stream : streams)
+    {
+        size_t remaining = stream.totalBytes - *stream.uploaded;
+        if (remaining == 0 || budget == 0)
+            continue;
+
+        size_t chunk = std::min(remaining, budget);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+        if (region)
+        {
+            std::memcpy(region + offsetInRegion, stream.source + *stream.uploaded, chunk);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                stagingRegion * frameBudget + offsetInRegion, *stream.uploaded, chunk);
+            offsetInRegion += chunk;
+        }
+        else
+        {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, *stream.uploaded, chunk, stream.source + *stream.uploaded);
+        }
+
+        // Mapped pages already copied need not stay resident
+        mapped.file.releasePages(stream.source + *stream.uploaded, chunk);
+        *stream.uploaded += chunk;
+        budget -= chunk;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (region)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        stagingFences[stagingRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stagingRegion = (stagingRegion + 1) % STAGING_REGIONS;
+    }
+
+    uploadFrames++;
+    return vertexBytesUploaded == vertexBytes && indexBytesUploaded == indexBytes;
+}
+
+Mesh *AsyncMeshLoader::update()
+{
+    if (state == State::Loading)
+    {
+        if (!workerDone.load(std::memory_order_acquire))
+            return nullptr;
+
+        worker.join();
+        if (!workerSucceeded)
+        {
+            LOG_ERROR("Failed to load model, keeping default cube: " << filename);
+            releaseSources();
+            state = State::Failed;
+            return nullptr;
+        }
+
+        // CPU data is ready; create the destination buffers and start streaming
+        pendingMesh = new Mesh();
+        if (mapped.vertexData)
+        {
+            vertexSource = mapped.vertexData;
+            vertexBytes = mapped.layout.vertexCount * Mesh::getVertexStride(mapped.layout.vertexFormat);
+            indexSource = reinterpret_cast<const unsigned char *>(mapped.indexData);
+            indexBytes = mapped.indexCount * sizeof(unsigned int);
+            pendingMesh->allocateBuffers(mapped.layout, mapped.indexCount);
+        }
+        else
+        {
+            vertexSource = data.vertexData.data();
+            vertexBytes = data.vertexData.size();
+            indexSource = reinterpret_cast<const unsigned char *>(data.indices.data());
+            indexBytes = data.indices.size() * sizeof(unsigned int);
+            pendingMesh->allocateBuffers(data, data.indices.size());
+        }
+        createStagingBuffer();
+        vertexBytesUploaded = 0;
+        indexBytesUploaded = 0;
+        state = State::Uploading;
+    }
+
+    if (state != State::Uploading)
+        return nullptr;
+
+    if (!uploadNextChunks())
+        return nullptr;
+
+    Mesh *mesh = pendingMesh;
+    pendingMesh = nullptr;
+    state = State::Idle;
+
+    // Release the CPU copy or mapping and the staging memory
+    size_t totalBytes = vertexBytes + indexBytes;
+    releaseSources();
+    destroyStagingBuffer();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::high_resolution_clock::now() - startTime);
+    LOG_INFO("Model resident: " << filename << " (" << totalBytes << " bytes in " << uploadFrames
+             << " frames, " << (elapsed.count() / 1000.0f) << "ms after request)");
+    return mesh;
+}
@@ -0,0 +1,366 @@
+#include "motion/BenchmarkResults.h"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+// Differences below this many milliseconds are measurement noise, never regressions
+static const double TIME_NOISE_MILLISECONDS = 0.01;
+
+static std::string quote(const std::string &text)
+{
+    std::string out = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static void writeSummary(std::ostream &out, const char *name, const FrameTimeHistory::Summary &summary)
+{
+    out << "      " << quote(name) << ": {\"samples\": " << summary.samples << ", \"p50\": " << summary.p50
+        << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << "}";
+}
+
+std::string benchmarkResultsToJson(const BenchmarkResults &results)
+{
+    std::ostringstream out;
+    out << std::setprecision(6);
+    out << "{\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"model\": " << quote(results.model) << ",\n";
+    out << "  \"keyframes\": " << quote(results.keyframes) << ",\n";
+    out << "  \"renderer\": " << quote(results.renderer) << ",\n";
+    out << "  \"instances\": " << results.instances << ",\n";
+    out << "  \"frames\": " << results.frames << ",\n";
+    out << "  \"width\": " << results.width << ",\n";
+    out << "  \"height\": " << results.height << ",\n";
+    out << "  \"peakRSSBytes\": " << results.peakRSSBytes << ",\n";
+    out << "  \"cases\": [";
+    for (size_t i = 0; i < results.cases.size(); i++)
+    {
+        const BenchmarkCase &entry = results.cases[i];
+        out << (i ? ",\n" : "\n") << "    {\n";
+        out << "      \"name\": " << quote(entry.name) << ",\n";
+        writeSummary(out, "cpuMs", entry.cpuMilliseconds);
+        out << ",\n";
+        writeSummary(out, "gpuMs", entry.gpuMilliseconds);
+        out << ",\n";
+        writeSummary(out, "evaluateMs", entry.evaluateMilliseconds);
+        out << ",\n";
+        out << "      \"drawCalls\": " << entry.drawCalls << ",\n";
+        out << "      \"stateChanges\": " << entry.stateChanges << "\n";
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+bool writeBenchmarkResults(const BenchmarkResults &results, const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "Cannot write benchmark results: " << path << std::endl;
+        return false;
+    }
+    file << benchmarkResultsToJson(results);
+    return static_cast<bool>(file);
+}
+
+// Just enough JSON to read back what benchmarkResultsToJson writes
+namespace
+{
+struct JsonValue
+{
+    enum class Type
+    {
+        Null,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    Type type = Type::Null;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items;
+    std::map<std::string, JsonValue> members;
+
+    const JsonValue *find(const char *key) const
+    {
+        auto it = members.find(key);
+        return it == members.end() ? nullptr : &it->second;
+    }
+    double numberAt(const char *key) const
+    {
+        const JsonValue *value = find(key);
+        return value && value->type == Type::Number ? value->number : 0.0;
+    }
+    std::string textAt(const char *key) const
+    {
+        const JsonValue *value = find(key);
+        return value && value->type == Type::String ? value->text : std::string();
+    }
+};
+
+class JsonParser
+{
+private:
+    const std::string &input;
+    size_t position;
+
+    void skipSpace()
+    {
+        while (position < input.size() && std::isspace(static_cast<unsigned char>(input[position])))
+            position++;
+    }
+
+    bool consume(char expected)
+    {
+        skipSpace();
+        if (position < input.size() && input[position] == expected)
+        {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseString(std::string &out)
+    {
+        if (!consume('"'))
+            return false;
+        while (position < input.size() && input[position] != '"')
+        {
+            char c = input[position++];
+            if (c == '\\' && position < input.size())
+            {
+                c = input[position++];
+                if (c == 'u' && position + 4 <= input.size())
+                {
+                    c = static_cast<char>(std::strtol(input.substr(position, 4).c_str(), nullptr, 16));
+                    position += 4;
+                }
+                else if (c == 'n')
+                {
+                    c = '\n';
+                }
+                else if (c == 't')
+                {
+                    c = '\t';
+                }
+            }
+            out += c;
+        }
+        return consume('"');
+    }
+
+public:
+    explicit JsonParser(const std::string &text) : input(text), position(0) {}
+
+    bool parse(JsonValue &value)
+    {
+        skipSpace();
+        if (position >= input.size())
+            return false;
+
+        char c = input[position];
+        if (c == '{')
+        {
+            position++;
+            value.type = JsonValue::Type::Object;
+            if (consume('}'))
+                return true;
+            do
+            {
+                std::string key;
+                if (!parseString(key) || !consume(':') || !parse(value.members[key]))
+                    return false;
+            } while (consume(','));
+            return consume('}');
+        }
+        if (c == '[')
+        {
+            position++;
+            value.type = JsonValue::Type::Array;
+            if (consume(']'))
+                return true;
+            do
+            {
+                value.items.emplace_back();
+                if (!parse(value.items.back()))
+                    return false;
+            } while (consume(','));
+            return consume(']');
+        }
+        if (c == '"')
+        {
+            value.type = JsonValue::Type::String;
+            return parseString(value.text);
+        }
+        if (input.compare(position, 4, "null") == 0)
+        {
+            position += 4;
+            return true;
+        }
+
+        char *end = nullptr;
+        value.number = std::strtod(input.c_str() + position, &end);
+        if (end == input.c_str() + position)
+            return false;
+        value.type = JsonValue::Type::Number;
+        position = end - input.c_str();
+        return true;
+    }
+};
+} // namespace
+
+static FrameTimeHistory::Summary readSummary(const JsonValue *value)
+{
+    FrameTimeHistory::Summary summary;
+    if (!value)
+        return summary;
+    summary.samples = static_cast<size_t>(value->numberAt("samples"));
+    summary.p50 = static_cast<float>(value->numberAt("p50"));
+    summary.p95 = static_cast<float>(value->numberAt("p95"));
+    summary.p99 = static_cast<float>(value->numberAt("p99"));
+    summary.max = static_cast<float>(value->numberAt("max"));
+    return summary;
+}
+
+bool readBenchmarkResults(const std::string &path, BenchmarkResults &results)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Cannot read benchmark baseline: " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    JsonValue root;
+    JsonParser parser(text);
+    if (!parser.parse(root) || root.type != JsonValue::Type::Object)
+    {
+        std::cerr << "Invalid benchmark baseline: " << path << std::endl;
+        return false;
+    }
+
+    results = BenchmarkResults();
+    results.model = root.textAt("model");
+    results.keyframes = root.textAt("keyframes");
+    results.renderer = root.textAt("renderer");
+    results.instances = static_cast<size_t>(root.numberAt("instances"));
+    results.frames = static_cast<size_t>(root.numberAt("frames"));
+    results.width = static_cast<int>(root.numberAt("width"));
+    results.height = static_cast<int>(root.numberAt("height"));
+    results.peakRSSBytes = static_cast<uint64_t>(root.numberAt("peakRSSBytes"));
+
+    if (const JsonValue *cases = root.find("cases"))
+    {
+        for (const JsonValue &item : cases->items)
+        {
+            BenchmarkCase entry;
+            entry.name = item.textAt("name");
+            entry.cpuMilliseconds = readSummary(item.find("cpuMs"));
+            entry.gpuMilliseconds = readSummary(item.find("gpuMs"));
+            entry.evaluateMilliseconds = readSummary(item.find("evaluateMs"));
+            entry.drawCalls = item.numberAt("drawCalls");
+            entry.stateChanges = item.numberAt("stateChanges");
+            results.cases.push_back(entry);
+        }
+    }
+    return true;
+}
+
+// Print one metric (lower is better) and return whether it regressed
+static bool compareMetric(const std::string &name, double current, double baseline, double threshold, double noise)
+{
+    double change = baseline > 0.0 ? (current - baseline) / baseline : 0.0;
+    bool regressed = current > baseline * (1.0 + threshold) && current - baseline > noise;
+
+    std::cout << "  " << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << baseline << std::setw(12) << current << std::setw(9) << std::setprecision(1)
+              << 100.0 * change << "%" << (regressed ? "  REGRESSION" : "") << std::endl;
+    return regressed;
+}
+
+int compareBenchmarkResults(const BenchmarkResults &results, const BenchmarkResults &baseline, double threshold)
+{
+    // Numbers from a different setup are still shown, but may not be comparable
+    if (results.model != baseline.model || results.keyframes != baseline.keyframes ||
+        results.instances != baseline.instances || results.frames != baseline.frames ||
+        results.width != baseline.width || results.height != baseline.height)
+        std::cerr << "WARNING: Baseline was recorded with a different model, keyframes, instances or frame size"
+                  << std::endl;
+    if (results.renderer != baseline.renderer)
+        std::cerr << "WARNING: Baseline was recorded on " << baseline.renderer << std::endl;
+
+    std::cout << "\nComparison with baseline (regression above +" << std::fixed << std::setprecision(1)
+              << 100.0 * threshold << "%)" << std::endl;
+    std::cout << "  " << std::left << std::setw(36) << "metric" << std::right << std::setw(12) << "baseline"
+              << std::setw(12) << "current" << std::setw(10) << "change" << std::endl;
+
+    int regressions = 0;
+    for (const BenchmarkCase &entry : results.cases)
+    {
+        const BenchmarkCase *reference = nullptr;
+        for (const BenchmarkCase &candidate : baseline.cases)
+        {
+            if (candidate.name == entry.name)
+                reference = &candidate;
+        }
+        if (!reference)
+        {
+            std::cout << "  " << entry.name << ": not in baseline" << std::endl;
+            continue;
+        }
+
+        const std::string &name = entry.name;
+        regressions += compareMetric(name + " cpu p50 ms", entry.cpuMilliseconds.p50,
+                                     reference->cpuMilliseconds.p50, threshold, TIME_NOISE_MILLISECONDS);
+        regressions += compareMetric(name + " cpu p95 ms", entry.cpuMilliseconds.p95,
+                                     reference->cpuMilliseconds.p95, threshold, TIME_NOISE_MILLISECONDS);
+        if (entry.gpuMilliseconds.samples > 0 && reference->gpuMilliseconds.samples > 0)
+        {
+            regressions += compareMetric(name + " gpu p50 ms", entry.gpuMilliseconds.p50,
+                                         reference->gpuMilliseconds.p50, threshold, TIME_NOISE_MILLISECONDS);
+            regressions += compareMetric(name + " gpu p95 ms", entry.gpuMilliseconds.p95,
+                                         reference->gpuMilliseconds.p95, threshold, TIME_NOISE_MILLISECONDS);
+        }
+        regressions += compareMetric(name + " evaluate p50 ms", entry.evaluateMilliseconds.p50,
+                                     reference->evaluateMilliseconds.p50, threshold, TIME_NOISE_MILLISECONDS);
+        regressions += compareMetric(name + " draw calls", entry.drawCalls, reference->drawCalls, threshold, 0.0);
+        regressions +=
+            compareMetric(name + " state changes", entry.stateChanges, reference->stateChanges, threshold, 0.0);
+    }
+    regressions += compareMetric("peak RSS MB", results.peakRSSBytes / 1048576.0, baseline.peakRSSBytes / 1048576.0,
+                                 threshold, 1.0);
+
+    std::cout << (regressions ? "  " + std::to_string(regressions) + " regressions" : std::string("  No regressions"))
+              << std::endl;
+    return regressions;
+}
@@ -0,0 +1,389 @@
+#include "motion/FrameExporter.h"
+#include "motion/GLStateCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <csignal>
+#endif
+
+static uint32_t crc32(const unsigned char *data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool tableReady = []()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++)
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            table[i] = value;
+        }
+        return true;
+    }();
+    (void)tableReady;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void appendBigEndian(std::vector<unsigned char> &out, uint32_t value)
+{
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+static void appendChunk(std::vector<unsigned char> &out, const char *type, const unsigned char *data, size_t size)
+{
+    appendBigEndian(out, static_cast<uint32_t>(size));
+    size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    appendBigEndian(out, crc32(out.data() + typeOffset, size + 4));
+}
+
+// PNG of top-down RGB rows. The image data is zlib-wrapped in stored (not
+// compressed) deflate blocks: encoding costs no more than a copy, and an
+// encoder on the pipe is the better place to spend time on compression.
+static void encodePNG(const unsigned char *rgb, int width, int height, std::vector<unsigned char> &out)
+{
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.assign(signature, signature + 8);
+
+    unsigned char header[13];
+    for (int i = 0; i < 4; i++)
+    {
+        header[i] = static_cast<unsigned char>(width >> (24 - 8 * i));
+        header[4 + i] = static_cast<unsigned char>(height >> (24 - 8 * i));
+    }
+    header[8] = 8;  // Bits per channel
+    header[9] = 2;  // RGB
+    header[10] = 0; // Deflate
+    header[11] = 0; // Adaptive filtering
+    header[12] = 0; // No interlace
+    appendChunk(out, "IHDR", header, sizeof(header));
+
+    // Filter byte 0 (none) before every row
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    size_t rawSize = (rowBytes + 1) * height;
+    const size_t MAX_BLOCK = 65535;
+
+    std::vector<unsigned char> zlib;
+    zlib.reserve(2 + rawSize + (rawSize / MAX_BLOCK + 1) * 5 + 4);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+
+    uint32_t adlerA = 1, adlerB = 0;
+    size_t adlerRun = 0;
+    size_t blockLeft = 0;
+    size_t remaining = rawSize;
+    auto emit = [&](const unsigned char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            if (blockLeft == 0)
+            {
+                // Stored block header: final flag, then length and its complement
+                blockLeft = std::min(remaining, MAX_BLOCK);
+                remaining -= blockLeft;
+                zlib.push_back(remaining == 0 ? 1 : 0);
+                zlib.push_back(static_cast<unsigned char>(blockLeft));
+                zlib.push_back(static_cast<unsigned char>(blockLeft >> 8));
+                zlib.push_back(static_cast<unsigned char>(~blockLeft));
+                zlib.push_back(static_cast<unsigned char>(~blockLeft >> 8));
+            }
+            size_t count = std::min(size, blockLeft);
+            zlib.insert(zlib.end(), data, data + count);
+            for (size_t i = 0; i < count; i++)
+            {
+                // Sums stay below 2^32 for 5552 bytes, so the modulo can wait
+                adlerA += data[i];
+                adlerB += adlerA;
+                if (++adlerRun == 5552)
+                {
+                    adlerA %= 65521;
+                    adlerB %= 65521;
+                    adlerRun = 0;
+                }
+            }
+            data += count;
+            size -= count;
+            blockLeft -= count;
+        }
+    };
+
+    const unsigned char filter = 0;
+    for (int y = 0; y < height; y++)
+    {
+        emit(&filter, 1);
+        emit(rgb + y * rowBytes, rowBytes);
+    }
+    appendBigEndian(zlib, ((adlerB % 65521) << 16) | (adlerA % 65521));
+
+    appendChunk(out, "IDAT", zlib.data(), zlib.size());
+    appendChunk(out, "IEND", nullptr, 0);
+}
+
+FrameExporter::FrameExporter()
+    : width(0), height(0), imageBytes(0), nextSlot(0), stopping(false), pipe(nullptr), writeErrors(0)
+{
+}
+
+FrameExporter::~FrameExporter()
+{
+    finish();
+}
+
+bool FrameExporter::start(int frameWidth, int frameHeight, const ExportOptions &exportOptions)
+{
+    finish();
+
+    options = exportOptions;
+    width = frameWidth;
+    height = frameHeight;
+    imageBytes = static_cast<size_t>(width) * height * 4;
+    stats = Stats();
+    writeErrors = 0;
+
+    int workerCount = 1;
+    if (options.pipeCommand.empty())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(options.directory, ec);
+        if (ec)
+        {
+            std::cerr << "Cannot create export directory: " << options.directory << std::endl;
+            return false;
+        }
+
+        workerCount = options.workerThreads;
+        if (workerCount <= 0)
+            workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+    else
+    {
+#ifndef _WIN32
+        // A closed encoder should fail the write, not kill the process
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        pipe = popen(options.pipeCommand.c_str(), "w");
+        if (!pipe)
+        {
+            std::cerr << "Cannot start encoder: " << options.pipeCommand << std::endl;
+            return false;
+        }
+    }
+
+    // Pack buffers only ever hold one frame each
+    slots.resize(std::max(options.framesInFlight, 1));
+    for (ReadbackSlot &slot : slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, imageBytes, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    nextSlot = 0;
+
+    // Two images per writer: one being written, one queued
+    images.assign(workerCount * 2, std::vector<unsigned char>(imageBytes));
+    freeImages.clear();
+    for (size_t i = 0; i < images.size(); i++)
+        freeImages.push_back(i);
+
+    stopping = false;
+    for (int i = 0; i < workerCount; i++)
+        workers.emplace_back(&FrameExporter::workerLoop, this);
+    return true;
+}
+
+void FrameExporter::capture(uint64_t frame)
+{
+    ReadbackSlot &slot = slots[nextSlot];
+    if (slot.fence)
+        retire(slot);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+
+    nextSlot = (nextSlot + 1) % slots.size();
+}
+
+void FrameExporter::retire(ReadbackSlot &slot)
+{
+    // Normally signalled frames ago; waiting here means the GPU is the bottleneck
+    auto waitStart = std::chrono::high_resolution_clock::now();
+    GLenum status = glClientWaitSync(slot.fence, 0, 0);
+    while (status == GL_TIMEOUT_EXPIRED)
+        status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    auto queueStart = std::chrono::high_resolution_clock::now();
+    stats.fenceWaitMilliseconds += std::chrono::duration<double, std::milli>(queueStart - waitStart).count();
+
+    // Waiting for a free image means the writers are the bottleneck
+    size_t image;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        imageFreed.wait(lock, [this]() { return !freeImages.empty(); });
+        image = freeImages.back();
+        freeImages.pop_back();
+    }
+    stats.queueWaitMilliseconds += std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - queueStart).count();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, imageBytes, GL_MAP_READ_BIT);
+    if (pixels)
+    {
+        std::memcpy(images[image].data(), pixels, imageBytes);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pixels)
+    {
+        std::cerr << "Failed to map readback of frame " << slot.frame << std::endl;
+        writeErrors++;
+        freeImages.push_back(image);
+        return;
+    }
+    jobs.push_back(Job{slot.frame, image});
+    jobReady.notify_one();
+    stats.frames++;
+}
+
+void FrameExporter::workerLoop()
+{
+    std::vector<unsigned char> rgb;
+    std::vector<unsigned char> encoded;
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        if (!writeImage(job.frame, images[job.image], rgb, encoded))
+            writeErrors++;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        freeImages.push_back(job.image);
+        imageFreed.notify_one();
+    }
+}
+
+bool FrameExporter::writeImage(uint64_t frame, const std::vector<unsigned char> &rgba, std::vector<unsigned char> &rgb,
+                               std::vector<unsigned char> &encoded)
+{
+    // GL rows start at the bottom; images start at the top. Alpha is dropped.
+    size_t rowBytes = static_cast<size_t>(width) * 3;
+    rgb.resize(rowBytes * height);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char *source = rgba.data() + static_cast<size_t>(height - 1 - y) * width * 4;
+        unsigned char *target = rgb.data() + y * rowBytes;
+        for (int x = 0; x < width; x++)
+        {
+            target[x * 3] = source[x * 4];
+            target[x * 3 + 1] = source[x * 4 + 1];
+            target[x * 3 + 2] = source[x * 4 + 2];
+        }
+    }
+
+    if (pipe)
+        return fwrite(rgb.data(), 1, rgb.size(), pipe) == rgb.size();
+
+    const char *extension = options.format == ExportFormat::PNG ? ".png"
+                            : options.format == ExportFormat::PPM ? ".ppm"
+                                                                  : ".rgb";
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%06llu%s", static_cast<unsigned long long>(frame), extension);
+    std::string path = (std::filesystem::path(options.directory) / name).string();
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Cannot write frame: " << path << std::endl;
+        return false;
+    }
+
+    bool written;
+    if (options.format == ExportFormat::PNG)
+    {
+        encodePNG(rgb.data(), width, height, encoded);
+        written = fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    }
+    else
+    {
+        if (options.format == ExportFormat::PPM)
+            fprintf(file, "P6\n%d %d\n255\n", width, height);
+        written = fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    }
+    return fclose(file) == 0 && written;
+}
+
+bool FrameExporter::finish()
+{
+    if (slots.empty())
+        return true;
+
+    // Oldest readbacks first, so a pipe still gets frames in order
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        ReadbackSlot &slot = slots[(nextSlot + i) % slots.size()];
+        if (slot.fence)
+            retire(slot);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+
+    for (ReadbackSlot &slot : slots)
+    {
+        GLStateCache::get().bufferDeleted(slot.buffer);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+    slots.clear();
+    images.clear();
+    freeImages.clear();
+
+    if (pipe)
+    {
+        if (pclose(pipe) != 0)
+        {
+            std::cerr << "Encoder exited with an error: " << options.pipeCommand << std::endl;
+            writeErrors++;
+        }
+        pipe = nullptr;
+    }
+
+    stats.writeErrors = writeErrors;
+    return stats.writeErrors == 0;
+}
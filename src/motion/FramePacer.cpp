@@ -0,0 +1,199 @@
+#include "motion/FramePacer.h"
+#include "motion/Logger.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// A frame is a hitch when its interval exceeds the expected one by this
+// factor: with vsync one missed blank already counts
+static const double PACED_HITCH_FACTOR = 1.5;
+static const double UNCAPPED_HITCH_FACTOR = 2.0;
+
+// Sleeps overshoot by up to a scheduler tick; the rest is waited out by yielding
+static const std::chrono::microseconds SPIN_MARGIN(1000);
+
+const char *pacingModeName(PacingMode mode)
+{
+    switch (mode)
+    {
+    case PacingMode::VSync:
+        return "vsync";
+    case PacingMode::Adaptive:
+        return "adaptive";
+    case PacingMode::Uncapped:
+        return "uncapped";
+    case PacingMode::Capped:
+        return "capped";
+    }
+    return "unknown";
+}
+
+FrameTimeHistory::Summary FrameTimeHistory::summarize() const
+{
+    sorted.assign(samples, samples + count);
+    return summarize(sorted);
+}
+
+FrameTimeHistory::Summary FrameTimeHistory::summarize(std::vector<float> &values)
+{
+    Summary summary;
+    summary.samples = values.size();
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+
+    // Nearest-rank percentiles
+    auto percentile = [&values](double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[std::max<size_t>(rank, 1) - 1];
+    };
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.max = values.back();
+    return summary;
+}
+
+FramePacer::FramePacer()
+    : mode(PacingMode::VSync), targetMilliseconds(0.0), capPeriod(0), hasLastSwap(false), medianInterval(0.0f),
+      seedCount(0), frameCount(0), hitchCount(0)
+{
+    reportStart = Clock::now();
+}
+
+void FramePacer::setMode(PacingMode pacingMode, double capRate)
+{
+    mode = pacingMode;
+    if (mode == PacingMode::Adaptive && !glfwExtensionSupported("GLX_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("WGL_EXT_swap_control_tear"))
+    {
+        LOG_WARNING("WARNING: Adaptive vsync unsupported by the driver, using vsync");
+        mode = PacingMode::VSync;
+    }
+
+    switch (mode)
+    {
+    case PacingMode::VSync:
+        glfwSwapInterval(1);
+        break;
+    case PacingMode::Adaptive:
+        glfwSwapInterval(-1);
+        break;
+    case PacingMode::Uncapped:
+    case PacingMode::Capped:
+        glfwSwapInterval(0);
+        break;
+    }
+
+    targetMilliseconds = 0.0;
+    capPeriod = Clock::duration(0);
+    if (mode == PacingMode::Capped && capRate > 0.0)
+    {
+        capPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / capRate));
+        targetMilliseconds = 1000.0 / capRate;
+    }
+    else if (mode == PacingMode::VSync || mode == PacingMode::Adaptive)
+    {
+        const GLFWvidmode *videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+        if (videoMode && videoMode->refreshRate > 0)
+            targetMilliseconds = 1000.0 / videoMode->refreshRate;
+    }
+
+    deadline = Clock::now();
+    hasLastSwap = false; // The switch itself is not a hitch
+    medianInterval = 0.0f; // Intervals of the old mode say nothing about the new one
+    seedCount = 0;
+    LogLine line(LogLevel::Info);
+    line.stream() << "Frame pacing: " << pacingModeName(mode);
+    if (targetMilliseconds > 0.0)
+        line.stream() << " (" << 1000.0 / targetMilliseconds << " Hz)";
+}
+
+void FramePacer::waitForFrame()
+{
+    if (mode != PacingMode::Capped || capPeriod == Clock::duration(0))
+        return;
+
+    deadline += capPeriod;
+    Clock::time_point now = Clock::now();
+    if (deadline < now)
+    {
+        // Running behind: start the schedule over instead of rushing frames to catch up
+        deadline = now;
+        return;
+    }
+
+    if (deadline - now > SPIN_MARGIN)
+        std::this_thread::sleep_until(deadline - SPIN_MARGIN);
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::endFrame(double cpuMilliseconds)
+{
+    Clock::time_point now = Clock::now();
+    cpuTimes.add(static_cast<float>(cpuMilliseconds));
+    frameCount++;
+
+    if (hasLastSwap)
+    {
+        double interval = std::chrono::duration<double, std::milli>(now - lastSwap).count();
+        intervals.add(static_cast<float>(interval));
+
+        if (targetMilliseconds > 0.0 || medianInterval > 0.0f)
+        {
+            double threshold = targetMilliseconds > 0.0 ? targetMilliseconds * PACED_HITCH_FACTOR
+                                                        : medianInterval * UNCAPPED_HITCH_FACTOR;
+            if (interval > threshold)
+                hitchCount++;
+        }
+        else
+        {
+            // Uncapped startup, when shader and mesh hitches happen: hold the
+            // first intervals back until their median is known
+            seedIntervals[seedCount++] = static_cast<float>(interval);
+            if (seedCount == MEDIAN_SEED_FRAMES)
+            {
+                std::vector<float> seed(seedIntervals, seedIntervals + seedCount);
+                finishSeed(FrameTimeHistory::summarize(seed).p50);
+            }
+        }
+    }
+    lastSwap = now;
+    hasLastSwap = true;
+}
+
+void FramePacer::finishSeed(float median)
+{
+    medianInterval = median;
+    for (size_t i = 0; i < seedCount; i++)
+    {
+        if (seedIntervals[i] > median * UNCAPPED_HITCH_FACTOR)
+            hitchCount++;
+    }
+    seedCount = 0;
+}
+
+FramePacer::Report FramePacer::report()
+{
+    Clock::time_point now = Clock::now();
+
+    Report result;
+    result.interval = intervals.summarize();
+    result.cpu = cpuTimes.summarize();
+    result.gpu = gpuTimes.summarize();
+    if (seedCount > 0)
+        finishSeed(result.interval.p50);
+    result.frames = frameCount;
+    result.hitches = hitchCount;
+    result.seconds = std::chrono::duration<double>(now - reportStart).count();
+
+    medianInterval = result.interval.p50;
+    frameCount = 0;
+    hitchCount = 0;
+    reportStart = now;
+    return result;
+}
@@ -0,0 +1,165 @@
+#include "motion/GLStateCache.h"
+
+GLStateCache::GLStateCache()
+{
+    invalidate();
+}
+
+GLStateCache &GLStateCache::get()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+void GLStateCache::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    arrayBuffer = UNKNOWN;
+    for (int i = 0; i < MAX_UNIFORM_BINDINGS; i++)
+        uniformRanges[i] = {UNKNOWN, 0, 0};
+    activeTextureUnit = UNKNOWN;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+        textures[i] = UNKNOWN;
+    depthTest = cullFace = blend = -1;
+}
+
+void GLStateCache::useProgram(unsigned int id)
+{
+    if (changed(program != id))
+    {
+        glUseProgram(id);
+        program = id;
+    }
+}
+
+void GLStateCache::bindVertexArray(unsigned int id)
+{
+    if (changed(vertexArray != id))
+    {
+        glBindVertexArray(id);
+        vertexArray = id;
+    }
+}
+
+void GLStateCache::bindArrayBuffer(unsigned int id)
+{
+    if (changed(arrayBuffer != id))
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, id);
+        arrayBuffer = id;
+    }
+}
+
+void GLStateCache::bindUniformBufferRange(unsigned int index, unsigned int buffer, GLintptr offset, GLsizeiptr size)
+{
+    if (index >= MAX_UNIFORM_BINDINGS)
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+        frameStats.stateChanges++;
+        return;
+    }
+
+    BufferRange &range = uniformRanges[index];
+    if (changed(range.buffer != buffer || range.offset != offset || range.size != size))
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size);
+        range = {buffer, offset, size};
+    }
+}
+
+void GLStateCache::bindTexture2D(unsigned int unit, unsigned int texture)
+{
+    if (unit >= MAX_TEXTURE_UNITS)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        activeTextureUnit = unit;
+        frameStats.stateChanges++;
+        return;
+    }
+
+    if (!changed(textures[unit] != texture))
+        return;
+
+    if (activeTextureUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeTextureUnit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    textures[unit] = texture;
+}
+
+int *GLStateCache::enableSlot(GLenum capability)
+{
+    switch (capability)
+    {
+    case GL_DEPTH_TEST:
+        return &depthTest;
+    case GL_CULL_FACE:
+        return &cullFace;
+    case GL_BLEND:
+        return &blend;
+    default:
+        return nullptr;
+    }
+}
+
+void GLStateCache::setEnabled(GLenum capability, bool enabled)
+{
+    int *slot = enableSlot(capability);
+    if (slot && !changed(*slot != static_cast<int>(enabled)))
+        return;
+
+    if (!slot)
+        frameStats.stateChanges++;
+
+    if (enabled)
+        glEnable(capability);
+    else
+        glDisable(capability);
+
+    if (slot)
+        *slot = enabled;
+}
+
+void GLStateCache::programDeleted(unsigned int id)
+{
+    // A deleted current program stays in use, so force the next useProgram through
+    if (program == id)
+        program = UNKNOWN;
+}
+
+void GLStateCache::vertexArrayDeleted(unsigned int id)
+{
+    // Deleting the bound vertex array reverts the binding to zero
+    if (vertexArray == id)
+        vertexArray = 0;
+}
+
+void GLStateCache::bufferDeleted(unsigned int id)
+{
+    if (arrayBuffer == id)
+        arrayBuffer = 0;
+    for (int i = 0; i < MAX_UNIFORM_BINDINGS; i++)
+    {
+        if (uniformRanges[i].buffer == id)
+            uniformRanges[i] = {0, 0, 0};
+    }
+}
+
+void GLStateCache::textureDeleted(unsigned int id)
+{
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+    {
+        if (textures[i] == id)
+            textures[i] = 0;
+    }
+}
+
+void GLStateCache::endFrame()
+{
+    lastFrameStats = frameStats;
+    frameStats = Stats();
+}
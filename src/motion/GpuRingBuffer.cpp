@@ -0,0 +1,195 @@
+#include "motion/GpuRingBuffer.h"
+#include "motion/GLStateCache.h"
+#include "motion/Logger.h"
+#include <algorithm>
+#include <chrono>
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+GpuRingBuffer::GpuRingBuffer()
+    : buffer(0)
+    , mappedMemory(nullptr)
+    , persistent(false)
+    , regionSize(0)
+    , alignment(16)
+    , region(0)
+    , regionUsed(0)
+    , lastOffset(0)
+    , lastSize(0)
+    , regionAcquired(false)
+    , frameCount(0)
+    , stallCount(0)
+    , stallMilliseconds(0.0)
+{
+    for (int i = 0; i < REGIONS; i++)
+        fences[i] = 0;
+}
+
+GpuRingBuffer::~GpuRingBuffer()
+{
+    destroy();
+}
+
+bool GpuRingBuffer::create(size_t regionBytes, size_t allocationAlignment)
+{
+    destroy();
+
+    alignment = std::max<size_t>(allocationAlignment, 1);
+    regionSize = alignUp(std::max<size_t>(regionBytes, 1), alignment);
+    GLsizeiptr totalSize = static_cast<GLsizeiptr>(regionSize * REGIONS);
+
+    // Internal uploads use the copy-write binding so callers' bindings are untouched
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, NULL, flags);
+        mappedMemory = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+        persistent = mappedMemory != nullptr;
+
+        if (!persistent)
+        {
+            // Storage is immutable, so the fallback needs a fresh buffer
+            LOG_WARNING("WARNING: Persistent ring buffer map failed, using staged uploads");
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        }
+    }
+
+    if (!persistent)
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, totalSize, NULL, GL_DYNAMIC_DRAW);
+        staging.resize(regionSize * REGIONS);
+        mappedMemory = staging.data();
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    region = 0;
+    regionUsed = 0;
+    regionAcquired = false;
+    return true;
+}
+
+void GpuRingBuffer::destroy()
+{
+    for (int i = 0; i < REGIONS; i++)
+    {
+        if (fences[i])
+        {
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+
+    if (buffer != 0)
+    {
+        if (persistent)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        GLStateCache::get().bufferDeleted(buffer);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+
+    mappedMemory = nullptr;
+    staging.clear();
+    staging.shrink_to_fit();
+    persistent = false;
+}
+
+bool GpuRingBuffer::acquireRegion(bool wait)
+{
+    GLsync &fence = fences[region];
+    if (fence)
+    {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            if (!wait)
+                return false;
+
+            // The GPU is still reading this region from REGIONS frames ago
+            auto start = std::chrono::high_resolution_clock::now();
+            do
+            {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (status == GL_TIMEOUT_EXPIRED);
+
+            stallCount++;
+            stallMilliseconds += std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+        }
+        glDeleteSync(fence);
+        fence = 0;
+    }
+
+    regionAcquired = true;
+    regionUsed = 0;
+    return true;
+}
+
+bool GpuRingBuffer::allocate(size_t size)
+{
+    size_t offset = alignUp(regionUsed, alignment);
+    if (offset + size > regionSize)
+    {
+        // Earlier allocations this frame keep the old buffer alive until the
+        // GPU is done with it; later frames use the larger one
+        size_t grownSize = std::max(regionSize * 2, alignUp(size, alignment));
+        LOG_INFO("Ring buffer region grown: " << regionSize << " -> " << grownSize << " bytes");
+        if (!create(grownSize, alignment))
+            return false;
+        regionAcquired = true;
+        offset = 0;
+    }
+
+    lastOffset = offset;
+    lastSize = size;
+    regionUsed = offset + size;
+    return true;
+}
+
+void *GpuRingBuffer::map(size_t bytes, bool wait)
+{
+    if (buffer == 0)
+        return nullptr;
+
+    if (!regionAcquired && !acquireRegion(wait))
+        return nullptr;
+
+    if (!allocate(bytes))
+        return nullptr;
+
+    return mappedMemory + getOffset();
+}
+
+void GpuRingBuffer::unmap()
+{
+    if (persistent || lastSize == 0)
+        return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, getOffset(), lastSize, mappedMemory + getOffset());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuRingBuffer::endFrame()
+{
+    if (!regionAcquired)
+        return;
+
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % REGIONS;
+    regionAcquired = false;
+    lastSize = 0;
+    frameCount++;
+}
@@ -0,0 +1,194 @@
+#include "motion/GpuTimer.h"
+#include "motion/Logger.h"
+#include <algorithm>
+
+GpuTimer::GpuTimer()
+    : available(false), created(false), frame(0), openCount(0), droppedFrames(0), frameGpuMilliseconds(0.0),
+      frameGpuReady(false)
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+    destroy();
+}
+
+bool GpuTimer::create()
+{
+    destroy();
+
+    // Timer queries are core in 3.3, but software and older drivers may lack them
+    available = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if (available)
+    {
+        GLint counterBits = 0;
+        glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+        available = counterBits > 0;
+    }
+
+    if (available)
+    {
+        for (FrameSlot &slot : frames)
+            glGenQueries(MAX_SCOPES * 2, slot.queries);
+    }
+    else
+    {
+        LOG_WARNING("WARNING: GL timer queries unavailable, only CPU pass times will be reported");
+    }
+
+    created = true;
+    return available;
+}
+
+void GpuTimer::destroy()
+{
+    if (!created)
+        return;
+
+    if (available)
+    {
+        for (FrameSlot &slot : frames)
+            glDeleteQueries(MAX_SCOPES * 2, slot.queries);
+    }
+    for (FrameSlot &slot : frames)
+        slot = FrameSlot();
+
+    created = false;
+    available = false;
+    openCount = 0;
+}
+
+GpuTimer::ScopeStats &GpuTimer::findStats(const char *name)
+{
+    for (ScopeStats &entry : stats)
+    {
+        if (entry.name == name)
+            return entry;
+    }
+    stats.push_back(ScopeStats());
+    stats.back().name = name;
+    return stats.back();
+}
+
+void GpuTimer::collect(FrameSlot &slot)
+{
+    slot.pending = false;
+
+    if (available)
+    {
+        // Results normally landed frames ago; if not, drop the frame rather than stall
+        bool ready = true;
+        for (int i = 0; i < slot.scopeCount * 2 && ready; i++)
+        {
+            GLint resultAvailable = 0;
+            glGetQueryObjectiv(slot.queries[i], GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+            ready = resultAvailable != 0;
+        }
+
+        if (ready)
+        {
+            GLuint64 frameStart = 0, frameEnd = 0;
+            for (int i = 0; i < slot.scopeCount; i++)
+            {
+                GLuint64 start = 0, end = 0;
+                glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &start);
+                glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+                ScopeStats &entry = findStats(slot.names[i]);
+                double milliseconds = (end - start) / 1e6;
+                entry.gpuMilliseconds += (milliseconds - entry.gpuMilliseconds) / ++entry.gpuSamples;
+
+                frameStart = i == 0 ? start : std::min(frameStart, start);
+                frameEnd = std::max(frameEnd, end);
+            }
+            frameGpuMilliseconds = (frameEnd - frameStart) / 1e6;
+            frameGpuReady = true;
+        }
+        else
+        {
+            droppedFrames++;
+        }
+    }
+
+    for (int i = 0; i < slot.scopeCount; i++)
+    {
+        ScopeStats &entry = findStats(slot.names[i]);
+        entry.cpuMilliseconds += (slot.cpuMilliseconds[i] - entry.cpuMilliseconds) / ++entry.cpuSamples;
+    }
+    slot.scopeCount = 0;
+}
+
+void GpuTimer::beginFrame()
+{
+    FrameSlot &slot = frames[frame % FRAME_LATENCY];
+    if (slot.pending)
+        collect(slot);
+    slot.scopeCount = 0;
+    openCount = 0;
+}
+
+void GpuTimer::endFrame()
+{
+    // Scopes left open are closed so their queries still complete
+    while (openCount > 0)
+        end();
+
+    FrameSlot &slot = frames[frame % FRAME_LATENCY];
+    slot.pending = slot.scopeCount > 0;
+    frame++;
+}
+
+void GpuTimer::begin(const char *name)
+{
+    FrameSlot &slot = frames[frame % FRAME_LATENCY];
+    if (slot.scopeCount == MAX_SCOPES)
+    {
+        // Out of queries: keep the nesting balanced but record nothing
+        if (openCount < MAX_SCOPES)
+            openScopes[openCount] = -1;
+        openCount++;
+        return;
+    }
+
+    int scope = slot.scopeCount++;
+    slot.names[scope] = name;
+    if (available)
+        glQueryCounter(slot.queries[scope * 2], GL_TIMESTAMP);
+
+    openScopes[openCount] = scope;
+    openTimes[openCount] = Clock::now();
+    openCount++;
+}
+
+void GpuTimer::end()
+{
+    if (openCount == 0)
+        return;
+
+    openCount--;
+    int scope = openCount < MAX_SCOPES ? openScopes[openCount] : -1;
+    if (scope < 0)
+        return;
+
+    FrameSlot &slot = frames[frame % FRAME_LATENCY];
+    if (available)
+        glQueryCounter(slot.queries[scope * 2 + 1], GL_TIMESTAMP);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - openTimes[openCount]);
+    slot.cpuMilliseconds[scope] = elapsed.count() / 1000.0;
+}
+
+bool GpuTimer::takeFrameGpuTime(double &milliseconds)
+{
+    if (!frameGpuReady)
+        return false;
+    milliseconds = frameGpuMilliseconds;
+    frameGpuReady = false;
+    return true;
+}
+
+void GpuTimer::resetStats()
+{
+    stats.clear();
+    droppedFrames = 0;
+}
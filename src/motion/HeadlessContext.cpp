@@ -0,0 +1,180 @@
+#include "motion/HeadlessContext.h"
+#include <cstring>
+#include <iostream>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+static bool hasExtension(const char *extensions, const char *name)
+{
+    if (!extensions)
+        return false;
+    size_t length = std::strlen(name);
+    for (const char *found = std::strstr(extensions, name); found; found = std::strstr(found + length, name))
+    {
+        // Match whole names only
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+// Surfaceless needs no GPU, display server or device node; Mesa renders with
+// llvmpipe when no hardware driver is present
+static EGLDisplay openDisplay()
+{
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        auto getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY)
+                return display;
+        }
+    }
+
+    std::cerr << "WARNING: EGL_MESA_platform_surfaceless unavailable, trying the default EGL display" << std::endl;
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
+HeadlessContext::HeadlessContext()
+    : display(nullptr), context(nullptr), framebuffer(0), colorRenderbuffer(0), depthRenderbuffer(0), width(0),
+      height(0)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+bool HeadlessContext::create(int framebufferWidth, int framebufferHeight)
+{
+    destroy();
+    width = framebufferWidth;
+    height = framebufferHeight;
+
+#ifdef HAVE_EGL
+    EGLDisplay eglDisplay = openDisplay();
+    EGLint major = 0, minor = 0;
+    if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+    {
+        std::cerr << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    display = eglDisplay;
+
+    if (!hasExtension(eglQueryString(eglDisplay, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+    {
+        std::cerr << "EGL display does not support surfaceless contexts" << std::endl;
+        destroy();
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "EGL does not support desktop OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+
+    // No surface at all; the surface type defaults to windows, which surfaceless lacks
+    const EGLint configAttributes[] = {EGL_SURFACE_TYPE, 0, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cerr << "No EGL config for desktop OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3,
+                                        EGL_CONTEXT_MINOR_VERSION, 3,
+                                        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                        EGL_NONE};
+    EGLContext eglContext = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+    if (eglContext == EGL_NO_CONTEXT)
+    {
+        std::cerr << "Failed to create an OpenGL 3.3 core context (EGL error 0x" << std::hex << eglGetError()
+                  << std::dec << ")" << std::endl;
+        destroy();
+        return false;
+    }
+    context = eglContext;
+
+    if (!eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, eglContext))
+    {
+        std::cerr << "Failed to make the headless context current" << std::endl;
+        destroy();
+        return false;
+    }
+
+    std::cout << "Headless EGL " << major << "." << minor << " context, " << width << "x" << height << std::endl;
+    return true;
+#else
+    std::cerr << "Headless mode needs a build with EGL" << std::endl;
+    return false;
+#endif
+}
+
+bool HeadlessContext::createFramebuffer()
+{
+    glGenRenderbuffers(1, &colorRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "Headless framebuffer incomplete: 0x" << std::hex << status << std::dec << std::endl;
+        return false;
+    }
+
+    // Left bound: everything the renderer draws lands here
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (framebuffer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorRenderbuffer);
+        glDeleteRenderbuffers(1, &depthRenderbuffer);
+        framebuffer = colorRenderbuffer = depthRenderbuffer = 0;
+    }
+
+#ifdef HAVE_EGL
+    if (display)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context)
+            eglDestroyContext(display, context);
+        eglTerminate(display);
+    }
+#endif
+    display = nullptr;
+    context = nullptr;
+}
@@ -0,0 +1,531 @@
+#include "motion/HudOverlay.h"
+#include "motion/Logger.h"
+#include "motion/Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+// Atlas layout: printable ASCII in 16 x 6 cells of 6 x 8 texels (a 5 x 7
+// glyph plus spacing). The last cell, DEL, is solid and used for boxes and bars.
+const int FIRST_GLYPH = 0x20;
+const int GLYPH_COUNT = 96;
+const int SOLID_GLYPH = 0x7F;
+const int CELL_WIDTH = 6;
+const int CELL_HEIGHT = 8;
+const int ATLAS_COLUMNS = 16;
+const int ATLAS_WIDTH = ATLAS_COLUMNS * CELL_WIDTH;
+const int ATLAS_HEIGHT = GLYPH_COUNT / ATLAS_COLUMNS * CELL_HEIGHT;
+const int LINE_HEIGHT = 10; // Cell plus two rows of leading
+
+// Classic 5 x 7 font, one byte per column, least significant bit at the top
+const unsigned char FONT_5X7[GLYPH_COUNT - 1][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, // space
+    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // $
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
+    {0x36, 0x49, 0x55, 0x22, 0x50}, // &
+    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
+    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, // *
+    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ;
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // <
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // >
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, // @
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, // F
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
+    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
+    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
+    {0x00, 0x7F, 0x41, 0x41, 0x00}, // [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
+    {0x00, 0x41, 0x41, 0x7F, 0x00}, // ]
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // _
+    {0x00, 0x01, 0x02, 0x04, 0x00}, // `
+    {0x20, 0x54, 0x54, 0x54, 0x78}, // a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
+    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
+    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
+    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, // k
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
+    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
+    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
+    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
+    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, // z
+    {0x00, 0x08, 0x36, 0x41, 0x00}, // {
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, // |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, // }
+    {0x08, 0x04, 0x08, 0x10, 0x08}, // ~
+};
+
+const std::chrono::milliseconds REFRESH_PERIOD(250);
+const float HITCH_FACTOR = 1.5f; // Bars longer than this times the median are drawn red
+const int MARGIN = 8;            // Pixels from the window corner, unscaled
+
+uint32_t rgba(unsigned r, unsigned g, unsigned b, unsigned a)
+{
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+const uint32_t PANEL_COLOR = rgba(0, 0, 0, 160);
+const uint32_t TEXT_COLOR = rgba(230, 230, 230, 255);
+const uint32_t REFERENCE_COLOR = rgba(255, 255, 255, 90);
+const uint32_t GOOD_COLOR = rgba(80, 220, 100, 220);
+const uint32_t HITCH_COLOR = rgba(240, 70, 60, 230);
+
+const char *VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+uniform vec2 viewportSize;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+void main()
+{
+    vec2 ndc = position / viewportSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    fragTexCoord = texCoord;
+    fragColor = color;
+}
+)";
+
+const char *FRAGMENT_SHADER = R"(#version 330 core
+in vec2 fragTexCoord;
+in vec4 fragColor;
+uniform sampler2D atlas;
+out vec4 outColor;
+void main()
+{
+    outColor = vec4(fragColor.rgb, fragColor.a * texture(atlas, fragTexCoord).r);
+}
+)";
+
+unsigned int compileStage(GLenum type, const char *source)
+{
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    int success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        LOG_ERROR("ERROR: HUD " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                  << " shader failed to compile");
+        LOG_ERROR(infoLog);
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+} // namespace
+
+HudOverlay::HudOverlay()
+    : program(0), vertexArray(0), vertexBuffer(0), atlas(0), viewportLocation(-1), viewportWidth(0),
+      viewportHeight(0), created(false), graphNext(0), hasLastFrame(false), graphReference(0.0f), textDirty(true),
+      textScale(0), framesSinceRefresh(0), hudCpuNanoseconds(0.0), lastAnimationTicks(0),
+      lastAnimationBusyNanoseconds(0)
+{
+    std::fill(graph, graph + GRAPH_SAMPLES, 0.0f);
+}
+
+HudOverlay::~HudOverlay()
+{
+    destroy();
+}
+
+bool HudOverlay::createAtlas()
+{
+    std::vector<unsigned char> texels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+    for (int glyph = 0; glyph < GLYPH_COUNT; glyph++)
+    {
+        int cellX = glyph % ATLAS_COLUMNS * CELL_WIDTH;
+        int cellY = glyph / ATLAS_COLUMNS * CELL_HEIGHT;
+        for (int y = 0; y < CELL_HEIGHT; y++)
+        {
+            for (int x = 0; x < CELL_WIDTH; x++)
+            {
+                bool set = FIRST_GLYPH + glyph == SOLID_GLYPH ||
+                           (x < 5 && y < 7 && (FONT_5X7[glyph][x] >> y & 1));
+                texels[(cellY + y) * ATLAS_WIDTH + cellX + x] = set ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &atlas);
+    GLStateCache::get().bindTexture2D(0, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    // Drawn at whole multiples of the cell size, so texels map to pixel blocks
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    return atlas != 0;
+}
+
+bool HudOverlay::createProgram()
+{
+    unsigned int vertexShader = compileStage(GL_VERTEX_SHADER, VERTEX_SHADER);
+    unsigned int fragmentShader = compileStage(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+    if (vertexShader == 0 || fragmentShader == 0)
+    {
+        if (vertexShader != 0) glDeleteShader(vertexShader);
+        if (fragmentShader != 0) glDeleteShader(fragmentShader);
+        return false;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        LOG_ERROR("ERROR: HUD shader program failed to link");
+        LOG_ERROR(infoLog);
+        return false;
+    }
+
+    GLStateCache::get().useProgram(program);
+    viewportLocation = glGetUniformLocation(program, "viewportSize");
+    glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+    return true;
+}
+
+bool HudOverlay::create()
+{
+    destroy();
+    created = true; // So a partial create is cleaned up
+
+    if (!createAtlas() || !createProgram())
+    {
+        LOG_WARNING("WARNING: Performance HUD unavailable");
+        destroy();
+        return false;
+    }
+
+    GLStateCache &cache = GLStateCache::get();
+    glGenVertexArrays(1, &vertexArray);
+    glGenBuffers(1, &vertexBuffer);
+    cache.bindVertexArray(vertexArray);
+    cache.bindArrayBuffer(vertexBuffer);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, x)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, u)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                          reinterpret_cast<void *>(offsetof(Vertex, color)));
+    glEnableVertexAttribArray(2);
+
+    // Nothing else in the application blends, so the function is set once
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    viewportWidth = viewportHeight = 0;
+    textDirty = true;
+    lastRefresh = Clock::now();
+    framesSinceRefresh = 0;
+    hudCpuNanoseconds = 0.0;
+    return true;
+}
+
+void HudOverlay::destroy()
+{
+    if (!created)
+        return;
+
+    GLStateCache &cache = GLStateCache::get();
+    if (vertexBuffer)
+    {
+        cache.bufferDeleted(vertexBuffer);
+        glDeleteBuffers(1, &vertexBuffer);
+    }
+    if (vertexArray)
+    {
+        cache.vertexArrayDeleted(vertexArray);
+        glDeleteVertexArrays(1, &vertexArray);
+    }
+    if (program)
+    {
+        cache.programDeleted(program);
+        glDeleteProgram(program);
+    }
+    if (atlas)
+    {
+        cache.textureDeleted(atlas);
+        glDeleteTextures(1, &atlas);
+    }
+    program = vertexArray = vertexBuffer = atlas = 0;
+    viewportLocation = -1;
+    created = false;
+}
+
+void HudOverlay::endFrame()
+{
+    Clock::time_point now = Clock::now();
+    if (hasLastFrame)
+    {
+        float interval = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+        graph[graphNext] = interval;
+        graphNext = (graphNext + 1) % GRAPH_SAMPLES;
+    }
+    lastFrame = now;
+    hasLastFrame = true;
+    framesSinceRefresh++;
+}
+
+bool HudOverlay::needsRefresh() const
+{
+    return Clock::now() - lastRefresh >= REFRESH_PERIOD;
+}
+
+void HudOverlay::refresh(const Counters &counters, const FramePacer &pacer)
+{
+    Clock::time_point start = Clock::now();
+    double seconds = std::chrono::duration<double>(start - lastRefresh).count();
+    uint64_t frames = std::max<uint64_t>(framesSinceRefresh, 1);
+
+    FrameTimeHistory::Summary interval = pacer.getIntervals().summarize();
+    FrameTimeHistory::Summary cpu = pacer.getCpuTimes().summarize();
+    FrameTimeHistory::Summary gpu = pacer.getGpuTimes().summarize();
+    graphReference = interval.p50;
+
+    char line[64];
+    lines.clear();
+    std::snprintf(line, sizeof(line), "%.1f fps  %s", seconds > 0.0 ? framesSinceRefresh / seconds : 0.0,
+                  counters.pacing);
+    lines.push_back(line);
+    lines.push_back("ms       p50    p95    p99");
+    auto percentiles = [&](const char *name, const FrameTimeHistory::Summary &summary)
+    {
+        if (summary.samples == 0)
+            std::snprintf(line, sizeof(line), "%-5s     n/a", name);
+        else
+            std::snprintf(line, sizeof(line), "%-5s %6.2f %6.2f %6.2f", name, summary.p50, summary.p95, summary.p99);
+        lines.push_back(line);
+    };
+    percentiles("frame", interval);
+    percentiles("cpu", cpu);
+    percentiles("gpu", gpu);
+
+    std::snprintf(line, sizeof(line), "draws %zu  instances %zu", counters.glStats.drawCalls, counters.instances);
+    lines.push_back(line);
+    std::snprintf(line, sizeof(line), "state %zu (%zu skipped)", counters.glStats.stateChanges,
+                  counters.glStats.redundantChanges);
+    lines.push_back(line);
+
+    // Animation cost per tick from the thread's running totals
+    uint64_t ticks = counters.animationTicks - lastAnimationTicks;
+    uint64_t busy = counters.animationBusyNanoseconds - lastAnimationBusyNanoseconds;
+    lastAnimationTicks = counters.animationTicks;
+    lastAnimationBusyNanoseconds = counters.animationBusyNanoseconds;
+    if (ticks > 0)
+        std::snprintf(line, sizeof(line), "anim %.3f ms/tick %.0f/s", busy / 1e6 / ticks,
+                      seconds > 0.0 ? ticks / seconds : 0.0);
+    else
+        std::snprintf(line, sizeof(line), "anim idle");
+    lines.push_back(line);
+
+    // The overlay's own cost: CPU per frame including these refreshes
+    double hudCpu = hudCpuNanoseconds / 1e6 / frames;
+    if (counters.hudGpuMilliseconds >= 0.0)
+        std::snprintf(line, sizeof(line), "hud cpu %.3f gpu %.3f ms", hudCpu, counters.hudGpuMilliseconds);
+    else
+        std::snprintf(line, sizeof(line), "hud cpu %.3f gpu n/a ms", hudCpu);
+    lines.push_back(line);
+
+    textDirty = true;
+    framesSinceRefresh = 0;
+    lastRefresh = start;
+    hudCpuNanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+void HudOverlay::addQuad(std::vector<Vertex> &out, float x, float y, float width, float height, float u0, float v0,
+                         float u1, float v1, uint32_t color)
+{
+    Vertex topLeft = {x, y, u0, v0, color};
+    Vertex topRight = {x + width, y, u1, v0, color};
+    Vertex bottomLeft = {x, y + height, u0, v1, color};
+    Vertex bottomRight = {x + width, y + height, u1, v1, color};
+    out.push_back(topLeft);
+    out.push_back(bottomLeft);
+    out.push_back(bottomRight);
+    out.push_back(topLeft);
+    out.push_back(bottomRight);
+    out.push_back(topRight);
+}
+
+void HudOverlay::addSolid(std::vector<Vertex> &out, float x, float y, float width, float height, uint32_t color)
+{
+    // Sample the middle of the solid cell
+    int glyph = SOLID_GLYPH - FIRST_GLYPH;
+    float u = (glyph % ATLAS_COLUMNS * CELL_WIDTH + CELL_WIDTH * 0.5f) / ATLAS_WIDTH;
+    float v = (glyph / ATLAS_COLUMNS * CELL_HEIGHT + CELL_HEIGHT * 0.5f) / ATLAS_HEIGHT;
+    addQuad(out, x, y, width, height, u, v, u, v, color);
+}
+
+void HudOverlay::buildText(int scale)
+{
+    textVertices.clear();
+    float x0 = static_cast<float>((MARGIN + 4) * scale);
+    float y = x0;
+    for (const std::string &text : lines)
+    {
+        float x = x0;
+        for (char c : text)
+        {
+            int glyph = static_cast<unsigned char>(c) - FIRST_GLYPH;
+            if (glyph > 0 && glyph < GLYPH_COUNT - 1)
+            {
+                float u = static_cast<float>(glyph % ATLAS_COLUMNS * CELL_WIDTH);
+                float v = static_cast<float>(glyph / ATLAS_COLUMNS * CELL_HEIGHT);
+                addQuad(textVertices, x, y, static_cast<float>(CELL_WIDTH * scale),
+                        static_cast<float>(CELL_HEIGHT * scale), u / ATLAS_WIDTH, v / ATLAS_HEIGHT,
+                        (u + CELL_WIDTH) / ATLAS_WIDTH, (v + CELL_HEIGHT) / ATLAS_HEIGHT, TEXT_COLOR);
+            }
+            x += CELL_WIDTH * scale;
+        }
+        y += LINE_HEIGHT * scale;
+    }
+    textScale = scale;
+    textDirty = false;
+}
+
+void HudOverlay::draw(int width, int height)
+{
+    if (!created || width <= 0 || height <= 0)
+        return;
+
+    PROFILE_SCOPE("hud");
+    Clock::time_point start = Clock::now();
+
+    // Double size unless the window is small
+    int scale = width >= 640 && height >= 480 ? 2 : 1;
+    if (textDirty || scale != textScale)
+        buildText(scale);
+
+    size_t columns = 0;
+    for (const std::string &text : lines)
+        columns = std::max(columns, text.size());
+    float padding = 4.0f * scale;
+    float panelX = static_cast<float>(MARGIN * scale);
+    float graphWidth = static_cast<float>(GRAPH_SAMPLES * scale);
+    float graphHeight = 32.0f * scale;
+    float textHeight = static_cast<float>(lines.size() * LINE_HEIGHT * scale);
+    float panelWidth = std::max(static_cast<float>(columns * CELL_WIDTH * scale), graphWidth) + 2.0f * padding;
+    float panelHeight = textHeight + graphHeight + 2.0f * padding;
+
+    vertices.clear();
+    addSolid(vertices, panelX, panelX, panelWidth, panelHeight, PANEL_COLOR);
+    vertices.insert(vertices.end(), textVertices.begin(), textVertices.end());
+
+    // Oldest interval on the left; the median sits at half height
+    float graphX = panelX + padding;
+    float graphBottom = panelX + padding + textHeight + graphHeight;
+    if (graphReference > 0.0f)
+    {
+        for (size_t i = 0; i < GRAPH_SAMPLES; i++)
+        {
+            float sample = graph[(graphNext + i) % GRAPH_SAMPLES];
+            if (sample <= 0.0f)
+                continue;
+            float barHeight = std::min(sample / (2.0f * graphReference), 1.0f) * graphHeight;
+            uint32_t color = sample > HITCH_FACTOR * graphReference ? HITCH_COLOR : GOOD_COLOR;
+            addSolid(vertices, graphX + i * scale, graphBottom - barHeight, static_cast<float>(scale), barHeight,
+                     color);
+        }
+        addSolid(vertices, graphX, graphBottom - graphHeight * 0.5f, graphWidth, static_cast<float>(scale),
+                 REFERENCE_COLOR);
+    }
+
+    GLStateCache &cache = GLStateCache::get();
+    cache.setEnabled(GL_DEPTH_TEST, false);
+    cache.setEnabled(GL_BLEND, true);
+    cache.useProgram(program);
+    if (width != viewportWidth || height != viewportHeight)
+    {
+        glUniform2f(viewportLocation, static_cast<float>(width), static_cast<float>(height));
+        viewportWidth = width;
+        viewportHeight = height;
+    }
+    cache.bindTexture2D(0, atlas);
+    cache.bindVertexArray(vertexArray);
+    cache.bindArrayBuffer(vertexBuffer);
+
+    // A fresh store each frame, so the driver never waits on last frame's draw
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+    cache.countDraw();
+
+    cache.setEnabled(GL_BLEND, false);
+    cache.setEnabled(GL_DEPTH_TEST, true);
+
+    hudCpuNanoseconds += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
@@ -0,0 +1,224 @@
+#include "motion/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+std::atomic<int> Logger::minimumLevel(static_cast<int>(LogLevel::Info));
+
+namespace
+{
+// How long the writer sleeps when the ring is empty
+const std::chrono::milliseconds WRITER_IDLE(2);
+
+// Bounded multi-producer ring (Vyukov): each slot's sequence says whose turn
+// it is. Equal to a producer's position: free to write. One past it: holds a
+// message for the consumer at that position. Producers claim positions with
+// a compare-exchange and never wait; a full ring fails the claim instead.
+struct Slot
+{
+    std::atomic<uint64_t> sequence;
+    LogLevel level;
+    uint32_t length;
+    char text[Logger::MESSAGE_BYTES];
+};
+
+struct LogState
+{
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> enqueuePosition{0};
+    uint64_t dequeuePosition = 0; // Writer thread, or stop once it has joined
+
+    std::atomic<bool> running{false};
+    std::atomic<int> activeProducers{0}; // Inside write while running; stop waits for them
+    std::atomic<uint64_t> dropped{0};
+    uint64_t reportedDrops = 0;
+
+    std::mutex controlMutex; // Serializes start and stop
+    std::thread writer;
+
+    LogState() : slots(new Slot[Logger::RING_SLOTS])
+    {
+        for (size_t i = 0; i < Logger::RING_SLOTS; i++)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    ~LogState(); // Stops a writer still running at exit
+};
+
+LogState &state()
+{
+    static LogState instance;
+    return instance;
+}
+
+FILE *streamFor(LogLevel level)
+{
+    return level >= LogLevel::Warning ? stderr : stdout;
+}
+
+bool enqueue(LogState &log, LogLevel level, const char *text, size_t length)
+{
+    const uint64_t mask = Logger::RING_SLOTS - 1;
+    uint64_t position = log.enqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Slot &slot = log.slots[position & mask];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence - position);
+        if (difference == 0)
+        {
+            if (log.enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.level = level;
+                slot.length = static_cast<uint32_t>(length);
+                std::memcpy(slot.text, text, length);
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+            // position was reloaded by the failed exchange
+        }
+        else if (difference < 0)
+        {
+            return false; // The writer has not freed this slot yet: full
+        }
+        else
+        {
+            position = log.enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+// Write out every complete message; true if there were any
+bool drain(LogState &log)
+{
+    const uint64_t mask = Logger::RING_SLOTS - 1;
+    bool wrote = false;
+    for (;;)
+    {
+        Slot &slot = log.slots[log.dequeuePosition & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != log.dequeuePosition + 1)
+            break;
+
+        FILE *stream = streamFor(slot.level);
+        std::fwrite(slot.text, 1, slot.length, stream);
+        std::fputc('\n', stream);
+        slot.sequence.store(log.dequeuePosition + Logger::RING_SLOTS, std::memory_order_release);
+        log.dequeuePosition++;
+        wrote = true;
+    }
+
+    uint64_t dropped = log.dropped.load(std::memory_order_relaxed);
+    if (dropped != log.reportedDrops)
+    {
+        std::fprintf(stderr, "WARNING: Log ring full, %llu messages dropped\n",
+                     static_cast<unsigned long long>(dropped - log.reportedDrops));
+        log.reportedDrops = dropped;
+        wrote = true;
+    }
+
+    // One flush per batch instead of one per line
+    if (wrote)
+    {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+    return wrote;
+}
+
+void writerLoop(LogState &log)
+{
+    while (log.running.load(std::memory_order_acquire))
+    {
+        if (!drain(log))
+            std::this_thread::sleep_for(WRITER_IDLE);
+    }
+}
+
+LogState::~LogState()
+{
+    if (writer.joinable())
+    {
+        running = false;
+        writer.join();
+        drain(*this);
+    }
+}
+} // namespace
+
+bool Logger::parseLevel(const char *name, LogLevel &level)
+{
+    static const struct
+    {
+        const char *name;
+        LogLevel level;
+    } levels[] = {{"debug", LogLevel::Debug},
+                  {"info", LogLevel::Info},
+                  {"warning", LogLevel::Warning},
+                  {"error", LogLevel::Error}};
+    for (const auto &entry : levels)
+    {
+        if (std::strcmp(name, entry.name) == 0)
+        {
+            level = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::start()
+{
+    LogState &log = state();
+    std::lock_guard<std::mutex> lock(log.controlMutex);
+    if (log.running)
+        return;
+
+    // Anything printed so far through std::cout or stdio comes first
+    std::fflush(stdout);
+    log.running = true;
+    log.writer = std::thread(writerLoop, std::ref(log));
+}
+
+void Logger::stop()
+{
+    LogState &log = state();
+    std::lock_guard<std::mutex> lock(log.controlMutex);
+    if (!log.running)
+        return;
+
+    // New messages now write directly; wait out the ones already claiming slots
+    log.running = false;
+    while (log.activeProducers.load() > 0)
+        std::this_thread::yield();
+    log.writer.join();
+    drain(log);
+}
+
+void Logger::write(LogLevel level, const char *text, size_t length)
+{
+    LogState &log = state();
+    length = std::min(length, MESSAGE_BYTES);
+
+    log.activeProducers.fetch_add(1);
+    if (log.running.load())
+    {
+        if (!enqueue(log, level, text, length))
+            log.dropped.fetch_add(1, std::memory_order_relaxed);
+        log.activeProducers.fetch_sub(1);
+        return;
+    }
+    log.activeProducers.fetch_sub(1);
+
+    FILE *stream = streamFor(level);
+    std::fwrite(text, 1, length, stream);
+    std::fputc('\n', stream);
+    std::fflush(stream);
+}
+
+uint64_t Logger::getDroppedCount()
+{
+    return state().dropped.load(std::memory_order_relaxed);
+}
@@ -1,7 +1,15 @@
 #include "motion/Mesh.h"
+#include "motion/GLStateCache.h"
+#include "motion/Logger.h"
+#include "motion/MeshSimplifier.h"
+#include <cstddef>
+#include <cstring>
+#include <future>
 
 // Mesh implementation
-Mesh::Mesh() : VAO(0), VBO(0), EBO(0) {}
+Mesh::Mesh()
+    : VAO(0), VBO(0), EBO(0), vertexFormat(VertexFormat::Float32), vertexCount(0),
+      indexCount(0), boundsMin(0.0f), boundsMax(0.0f) {}
 
 Mesh::~Mesh()
 {
@@ -12,6 +20,9 @@ void Mesh::cleanup()
 {
     if (VAO != 0)
     {
+        GLStateCache &state = GLStateCache::get();
+        state.vertexArrayDeleted(VAO);
+        state.bufferDeleted(VBO);
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
         if (EBO != 0)
@@ -20,17 +31,67 @@ void Mesh::cleanup()
     }
 }
 
-void Mesh::setupBuffers()
+size_t Mesh::getVertexStride(VertexFormat format)
 {
-    cleanup();
+    return vertexStride(format);
+}
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
+glm::vec3 Mesh::getPositionScale() const
+{
+    return vertexFormat == VertexFormat::Compact ? quantizationScale(boundsMin, boundsMax) : glm::vec3(1.0f);
+}
+
+glm::vec3 Mesh::getPositionOffset() const
+{
+    return vertexFormat == VertexFormat::Compact ? boundsMin : glm::vec3(0.0f);
+}
 
-    glBindVertexArray(VAO);
+void Mesh::computeBounds(glm::vec3 &minBounds, glm::vec3 &maxBounds) const
+{
+    if (vertices.empty())
+    {
+        minBounds = maxBounds = glm::vec3(0.0f);
+        return;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    minBounds = maxBounds = glm::vec3(vertices[0], vertices[1], vertices[2]);
+    for (size_t i = 8; i + 2 < vertices.size(); i += 8)
+    {
+        glm::vec3 p(vertices[i], vertices[i + 1], vertices[i + 2]);
+        minBounds = glm::min(minBounds, p);
+        maxBounds = glm::max(maxBounds, p);
+    }
+}
+
+void Mesh::packCompactVertices(const glm::vec3 &minBounds, const glm::vec3 &maxBounds, CompactVertex *out) const
+{
+    glm::vec3 scale = quantizationScale(minBounds, maxBounds);
+    size_t numVertices = vertices.size() / 8;
+    for (size_t v = 0; v < numVertices; v++)
+    {
+        packCompactVertex(&vertices[v * 8], minBounds, scale, out[v]);
+    }
+}
+
+void Mesh::setupVertexAttributes()
+{
+    if (vertexFormat == VertexFormat::Compact)
+    {
+        GLsizei stride = sizeof(CompactVertex);
+
+        // Position attribute (location = 0), normalized against the mesh bounds
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void *)offsetof(CompactVertex, position));
+        glEnableVertexAttribArray(0);
+
+        // Normal attribute (location = 1), packed signed 10-10-10-2
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void *)offsetof(CompactVertex, normal));
+        glEnableVertexAttribArray(1);
+
+        // Texture coordinate attribute (location = 2), half floats
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void *)offsetof(CompactVertex, texcoord));
+        glEnableVertexAttribArray(2);
+        return;
+    }
 
     // Position attribute (location = 0)
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
@@ -43,196 +104,295 @@ void Mesh::setupBuffers()
     // Texture coordinate attribute (location = 2)
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
+}
 
-    if (!indices.empty())
+void Mesh::uploadBuffers(const void *vertexData, size_t numVertices, const unsigned int *indexData, size_t numIndices)
+{
+    cleanup();
+
+    vertexCount = numVertices;
+    indexCount = numIndices;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    GLStateCache &state = GLStateCache::get();
+    state.bindVertexArray(VAO);
+
+    state.bindArrayBuffer(VBO);
+    glBufferData(GL_ARRAY_BUFFER, numVertices * getVertexStride(vertexFormat), vertexData, GL_STATIC_DRAW);
+
+    setupVertexAttributes();
+
+    if (numIndices > 0)
     {
         glGenBuffers(1, &EBO);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
     }
 
-    glBindVertexArray(0);
+    state.bindVertexArray(0);
+
+    if (vertexFormat == VertexFormat::Compact)
+    {
+        size_t floatBytes = numVertices * getVertexStride(VertexFormat::Float32);
+        size_t compactBytes = getVertexBufferBytes();
+        LOG_INFO("Compact vertex buffer: " << compactBytes << " bytes vs " << floatBytes << " bytes float layout ("
+                 << (100 - compactBytes * 100 / std::max<size_t>(floatBytes, 1)) << "% less memory and vertex fetch)");
+    }
 }
 
-void Mesh::render()
+void Mesh::allocateBuffers(const MeshData &layout, size_t layoutIndexCount)
 {
-    glBindVertexArray(VAO);
-    if (!indices.empty())
+    cleanup();
+
+    vertexFormat = layout.vertexFormat;
+    vertexCount = layout.vertexCount;
+    indexCount = layoutIndexCount;
+    boundsMin = layout.boundsMin;
+    boundsMax = layout.boundsMax;
+    lods = layout.lods;
+    meshlets = layout.meshlets;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+
+    GLStateCache &state = GLStateCache::get();
+    state.bindVertexArray(VAO);
+
+    state.bindArrayBuffer(VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * getVertexStride(vertexFormat), NULL, GL_STATIC_DRAW);
+
+    setupVertexAttributes();
+
+    if (indexCount > 0)
+    {
+        glGenBuffers(1, &EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+    }
+
+    state.bindVertexArray(0);
+}
+
+void Mesh::buildMeshData(MeshData &out) const
+{
+    out.vertexFormat = vertexFormat;
+    out.vertexCount = vertices.size() / 8;
+    out.indices = indices;
+    out.lods = lods;
+    out.meshlets = meshlets;
+    computeBounds(out.boundsMin, out.boundsMax);
+
+    out.vertexData.resize(out.vertexCount * getVertexStride(vertexFormat));
+    if (vertexFormat == VertexFormat::Compact)
     {
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        packCompactVertices(out.boundsMin, out.boundsMax, reinterpret_cast<CompactVertex *>(out.vertexData.data()));
+    }
+    else if (!vertices.empty())
+    {
+        std::memcpy(out.vertexData.data(), vertices.data(), vertices.size() * sizeof(float));
+    }
+}
+
+void Mesh::uploadMeshData(const MeshData &data)
+{
+    vertexFormat = data.vertexFormat;
+    boundsMin = data.boundsMin;
+    boundsMax = data.boundsMax;
+    lods = data.lods;
+    meshlets = data.meshlets;
+    uploadBuffers(data.vertexData.data(), data.vertexCount, data.indices.data(), data.indices.size());
+}
+
+void Mesh::setupBuffers()
+{
+    computeBounds(boundsMin, boundsMax);
+
+    size_t numVertices = vertices.size() / 8;
+    if (vertexFormat == VertexFormat::Compact)
+    {
+        std::vector<CompactVertex> packed(numVertices);
+        packCompactVertices(boundsMin, boundsMax, packed.data());
+        uploadBuffers(packed.data(), numVertices, indices.data(), indices.size());
     }
     else
     {
-        glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 8);
+        uploadBuffers(vertices.data(), numVertices, indices.data(), indices.size());
     }
-    glBindVertexArray(0);
 }
 
-// OBJLoader implementation
-glm::vec3 OBJLoader::calculateNormal(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2)
+void Mesh::render()
 {
-    glm::vec3 edge1 = v1 - v0;
-    glm::vec3 edge2 = v2 - v0;
-    return glm::normalize(glm::cross(edge1, edge2));
+    render(0);
 }
 
-bool OBJLoader::loadOBJ(const std::string &path, Mesh &mesh)
+void Mesh::render(size_t lod)
 {
-    std::ifstream file(path);
-    if (!file.is_open())
+    GLStateCache &state = GLStateCache::get();
+    state.bindVertexArray(VAO);
+    state.countDraw();
+    if (!lods.empty())
+    {
+        const MeshLod &level = lods[std::min(lod, lods.size() - 1)];
+        glDrawElements(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT,
+                       (void *)(level.indexOffset * sizeof(unsigned int)));
+    }
+    else if (indexCount > 0)
     {
-        std::cerr << "Failed to open OBJ file: " << path << std::endl;
-        return false;
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
     }
+    else
+    {
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    }
+}
 
-    temp_vertices.clear();
-    temp_uvs.clear();
-    temp_normals.clear();
-    mesh.vertices.clear();
-    mesh.indices.clear();
+void Mesh::weldIfUnindexed()
+{
+    if (!indices.empty())
+        return;
 
-    std::string line;
-    std::vector<std::vector<int>> vertexIndices, uvIndices, normalIndices;
-    bool hasNormals = false;
-    bool hasUVs = false;
+    size_t before = vertices.size() / 8;
+    indices = MeshSimplifier::weldVertices(vertices, 8);
+    LOG_INFO("Welded vertices: " << before << " -> " << vertices.size() / 8);
+}
 
-    while (std::getline(file, line))
+void Mesh::generateLods(const std::vector<float> &triangleRatios)
+{
+    lods.clear();
+    if (triangleRatios.empty() || vertices.empty())
+        return;
+
+    weldIfUnindexed();
+
+    // Every level simplifies the full mesh independently, so they build in parallel
+    size_t baseTriangles = indices.size() / 3;
+    std::vector<float> ratios;
+    for (float ratio : triangleRatios)
     {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
+        if (ratio > 0.0f && ratio < 1.0f)
+            ratios.push_back(ratio);
+    }
+    std::sort(ratios.begin(), ratios.end(), std::greater<float>());
 
-        if (prefix == "v")
-        {
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            temp_vertices.push_back(vertex);
-        }
-        else if (prefix == "vt")
-        {
-            glm::vec2 uv;
-            iss >> uv.x >> uv.y;
-            temp_uvs.push_back(uv);
-            hasUVs = true;
-        }
-        else if (prefix == "vn")
-        {
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-            hasNormals = true;
-        }
-        else if (prefix == "f")
+    std::vector<float> errors(ratios.size(), 0.0f);
+    std::vector<std::future<std::vector<unsigned int>>> levels;
+    for (size_t i = 0; i < ratios.size(); i++)
+    {
+        size_t target = std::max<size_t>(1, static_cast<size_t>(baseTriangles * ratios[i]));
+        levels.push_back(std::async(std::launch::async, [this, target, &errors, i]()
         {
-            std::vector<int> vIndices, uvIdx, nIdx;
-            std::string vertex;
-
-            while (iss >> vertex)
-            {
-                std::replace(vertex.begin(), vertex.end(), '/', ' ');
-                std::istringstream viss(vertex);
-
-                int vi, uvi = 0, ni = 0;
-                viss >> vi;
-                if (viss >> uvi)
-                {
-                    if (viss >> ni)
-                    {
-                        // Format: v/vt/vn
-                    }
-                    // Format: v/vt or v/vt/vn
-                }
-                else
-                {
-                    // Format: v or v//vn
-                    std::istringstream checkNormal(vertex);
-                    std::string temp;
-                    checkNormal >> temp >> temp >> ni;
-                }
-
-                vIndices.push_back(vi - 1); // OBJ indices are 1-based
-                uvIdx.push_back(uvi > 0 ? uvi - 1 : 0);
-                nIdx.push_back(ni > 0 ? ni - 1 : 0);
-            }
-
-            // Triangulate faces (assuming they are quads or triangles)
-            for (size_t i = 1; i < vIndices.size() - 1; i++)
-            {
-                vertexIndices.push_back({vIndices[0], vIndices[i], vIndices[i + 1]});
-                uvIndices.push_back({uvIdx[0], uvIdx[i], uvIdx[i + 1]});
-                normalIndices.push_back({nIdx[0], nIdx[i], nIdx[i + 1]});
-            }
-        }
+            return MeshSimplifier::simplify(vertices.data(), 8, vertices.size() / 8, indices, target, errors[i]);
+        }));
     }
 
-    file.close();
+    std::vector<std::vector<unsigned int>> results;
+    for (auto &level : levels)
+        results.push_back(level.get());
 
-    if (temp_vertices.empty())
+    lods.push_back({0, static_cast<unsigned int>(indices.size()), 0.0f});
+    for (size_t i = 0; i < results.size(); i++)
     {
-        std::cerr << "No vertices found in OBJ file" << std::endl;
-        return false;
+        MeshLod lod = {static_cast<unsigned int>(indices.size()), static_cast<unsigned int>(results[i].size()), errors[i]};
+        indices.insert(indices.end(), results[i].begin(), results[i].end());
+        lods.push_back(lod);
+        LOG_INFO("LOD " << lods.size() - 1 << ": " << lod.indexCount / 3 << " triangles (error "
+                 << lod.error << ")");
     }
+}
+
+void Mesh::generateMeshlets()
+{
+    meshlets.clear();
+    if (vertices.empty())
+        return;
+
+    weldIfUnindexed();
+    size_t levelIndices = lods.empty() ? indices.size() : lods[0].indexCount;
+    MeshletBuilder::build(vertices.data(), 8, indices, 0, levelIndices, meshlets);
+    LOG_INFO("Built " << meshlets.size() << " meshlets (" << MeshletBuilder::MAX_VERTICES << " vertices, "
+             << MeshletBuilder::MAX_TRIANGLES << " triangles max)");
+}
 
-    // Process faces
-    for (size_t i = 0; i < vertexIndices.size(); i++)
+void Mesh::renderCulled(const glm::mat4 &modelViewProjection, const glm::vec3 &camera, MeshletCullStats &stats)
+{
+    if (meshlets.empty())
     {
-        glm::vec3 faceNormal;
+        stats = MeshletCullStats();
+        render(0);
+        return;
+    }
 
-        if (!hasNormals)
-        {
-            // Calculate face normal
-            faceNormal = calculateNormal(
-                temp_vertices[vertexIndices[i][0]],
-                temp_vertices[vertexIndices[i][1]],
-                temp_vertices[vertexIndices[i][2]]);
-        }
-
-        for (int j = 0; j < 3; j++)
-        {
-            int vIdx = vertexIndices[i][j];
-            int uvIdx = hasUVs ? uvIndices[i][j] : 0;
-            int nIdx = hasNormals ? normalIndices[i][j] : 0;
-
-            // Add vertex position
-            mesh.vertices.push_back(temp_vertices[vIdx].x);
-            mesh.vertices.push_back(temp_vertices[vIdx].y);
-            mesh.vertices.push_back(temp_vertices[vIdx].z);
-
-            // Add normal
-            if (hasNormals && nIdx < static_cast<int>(temp_normals.size()))
-            {
-                mesh.vertices.push_back(temp_normals[nIdx].x);
-                mesh.vertices.push_back(temp_normals[nIdx].y);
-                mesh.vertices.push_back(temp_normals[nIdx].z);
-            }
-            else
-            {
-                mesh.vertices.push_back(faceNormal.x);
-                mesh.vertices.push_back(faceNormal.y);
-                mesh.vertices.push_back(faceNormal.z);
-            }
-
-            // Add texture coordinates
-            if (hasUVs && uvIdx < static_cast<int>(temp_uvs.size()))
-            {
-                mesh.vertices.push_back(temp_uvs[uvIdx].x);
-                mesh.vertices.push_back(temp_uvs[uvIdx].y);
-            }
-            else
-            {
-                mesh.vertices.push_back(0.0f);
-                mesh.vertices.push_back(0.0f);
-            }
-        }
+    glm::vec4 planes[6];
+    MeshletBuilder::extractFrustumPlanes(modelViewProjection, planes);
+    MeshletBuilder::cull(meshlets, planes, camera, drawCounts, drawOffsets, stats);
+    if (drawCounts.empty())
+        return;
+
+    GLStateCache &state = GLStateCache::get();
+    state.bindVertexArray(VAO);
+    state.countDraw();
+    glMultiDrawElements(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawOffsets.data(),
+                        static_cast<GLsizei>(drawCounts.size()));
+}
+
+void Mesh::bindInstanceBuffer(unsigned int buffer, size_t offset)
+{
+    if (VAO == 0)
+        return;
+
+    GLStateCache &state = GLStateCache::get();
+    state.bindVertexArray(VAO);
+    state.bindArrayBuffer(buffer);
+    GLsizei stride = sizeof(InstanceData);
+
+    // Model matrix (locations 3-6), one vec4 column per location
+    for (int column = 0; column < 4; column++)
+    {
+        GLuint location = 3 + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)(offset + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
     }
 
-    std::cout << "Loaded OBJ file: " << path << std::endl;
-    std::cout << "Vertices: " << temp_vertices.size() << std::endl;
-    std::cout << "Faces: " << vertexIndices.size() << std::endl;
-    std::cout << "Has normals: " << (hasNormals ? "Yes" : "No (calculated)") << std::endl;
-    std::cout << "Has UVs: " << (hasUVs ? "Yes" : "No") << std::endl;
+    // Normal matrix (locations 7-9), one vec3 column per location
+    for (int column = 0; column < 3; column++)
+    {
+        GLuint location = 7 + column;
+        glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride,
+                              (void *)(offset + offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
 
-    return true;
+void Mesh::renderInstanced(size_t instanceCount)
+{
+    GLStateCache &state = GLStateCache::get();
+    state.bindVertexArray(VAO);
+    state.countDraw();
+    if (!lods.empty())
+    {
+        glDrawElementsInstanced(GL_TRIANGLES, lods[0].indexCount, GL_UNSIGNED_INT,
+                                (void *)(lods[0].indexOffset * sizeof(unsigned int)), instanceCount);
+    }
+    else if (indexCount > 0)
+    {
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instanceCount);
+    }
+    else
+    {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount);
+    }
+}
+
+// Defined here rather than in OBJLoader.cpp, which stays free of GL
+bool OBJLoader::loadOBJ(const std::string &path, Mesh &mesh)
+{
+    mesh.indices.clear();
+    return loadOBJ(path, mesh.vertices);
 }
 
 // Create a default cube mesh
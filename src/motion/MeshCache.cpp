@@ -0,0 +1,486 @@
+#include "motion/MeshCache.h"
+#include "motion/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const uint32_t MESH_CACHE_MAX_LODS = 16;
+
+// On-disk layout: header (with the LOD table), then vertex, index and
+// meshlet blobs each aligned to a page
+struct MeshCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexFormat;
+    uint32_t vertexStride;
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t meshletCount;
+    uint64_t meshletOffset;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t contentHash;
+    uint64_t pathHash;
+    uint64_t processingHash;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t lodCount;
+    MeshLod lods[MESH_CACHE_MAX_LODS];
+};
+
+static const char MESH_CACHE_MAGIC[4] = {'K', 'F', 'M', 'S'};
+static const uint64_t MESH_CACHE_ALIGNMENT = 4096;
+
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1);
+}
+
+uint64_t hashBytes(const void *data, size_t size, uint64_t seed)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// MappedFile implementation
+#ifdef _WIN32
+MappedFile::MappedFile() : data(nullptr), size(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+#else
+MappedFile::MappedFile() : data(nullptr), size(0) {}
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void *view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED)
+        return false;
+
+    madvise(view, st.st_size, MADV_SEQUENTIAL);
+    data = static_cast<const unsigned char *>(view);
+    size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    mappingHandle = fileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char *>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::releasePages(const unsigned char *begin, size_t bytes) const
+{
+    if (!data || begin < data || begin + bytes > data + size)
+        return;
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t pageSize = info.dwPageSize;
+#else
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    // The page holding begin was consumed up to begin by earlier calls, so only
+    // the end is rounded down to keep a partly consumed page resident
+    size_t first = static_cast<size_t>(begin - data) / pageSize * pageSize;
+    size_t last = static_cast<size_t>(begin + bytes - data) / pageSize * pageSize;
+    if (last <= first)
+        return;
+
+#ifdef _WIN32
+    // Unlocking pages that are not locked removes them from the working set
+    VirtualUnlock(const_cast<unsigned char *>(data) + first, last - first);
+#else
+    madvise(const_cast<unsigned char *>(data) + first, last - first, MADV_DONTNEED);
+#endif
+}
+
+// MeshCache implementation
+MeshCache::MeshCache(const std::string &cacheDirectory) : directory(cacheDirectory) {}
+
+bool MeshCache::buildKey(const std::string &sourcePath, VertexFormat format, MeshCacheKey &key) const
+{
+    std::error_code ec;
+    std::filesystem::path source = std::filesystem::absolute(sourcePath, ec);
+    if (ec)
+        return false;
+
+    auto mtime = std::filesystem::last_write_time(source, ec);
+    if (ec)
+        return false;
+
+    // Hashing the mapped file is far cheaper than parsing it and catches
+    // edits that preserve size and mtime
+    MappedFile file;
+    if (!file.open(source.string()))
+        return false;
+
+    key.sourcePath = source.lexically_normal().string();
+    key.sourceSize = file.getSize();
+    key.sourceMtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    key.contentHash = hashBytes(file.getData(), file.getSize());
+    key.vertexFormat = format;
+    return true;
+}
+
+std::string MeshCache::getCachePath(const MeshCacheKey &key) const
+{
+    // One entry per source path, vertex format and processing settings
+    uint64_t pathHash = hashBytes(key.sourcePath.data(), key.sourcePath.size());
+    std::ostringstream name;
+    name << std::filesystem::path(key.sourcePath).stem().string() << "-" << std::hex << std::setw(16)
+         << std::setfill('0') << pathHash << (key.vertexFormat == VertexFormat::Compact ? "-c" : "-f");
+    if (key.processingHash != 0)
+        name << "-" << std::setw(8) << (key.processingHash & 0xffffffffu);
+    name << ".kfmesh";
+    return (std::filesystem::path(directory) / name.str()).string();
+}
+
+bool MeshCache::mapEntry(const MeshCacheKey &key, MappedFile &file, MappedEntry &entry) const
+{
+    if (!file.open(getCachePath(key)))
+        return false;
+
+    if (file.getSize() < sizeof(MeshCacheHeader))
+        return false;
+
+    MeshCacheHeader header;
+    std::memcpy(&header, file.getData(), sizeof(header));
+
+    size_t stride = Mesh::getVertexStride(key.vertexFormat);
+    if (std::memcmp(header.magic, MESH_CACHE_MAGIC, 4) != 0 ||
+        header.version != VERSION ||
+        header.vertexFormat != static_cast<uint32_t>(key.vertexFormat) ||
+        header.vertexStride != stride ||
+        header.sourceSize != key.sourceSize ||
+        header.sourceMtime != key.sourceMtime ||
+        header.contentHash != key.contentHash ||
+        header.processingHash != key.processingHash ||
+        header.pathHash != hashBytes(key.sourcePath.data(), key.sourcePath.size()))
+    {
+        LOG_INFO("Mesh cache stale, rebuilding: " << getCachePath(key));
+        return false;
+    }
+
+    uint64_t vertexBytes = header.vertexCount * stride;
+    uint64_t indexBytes = header.indexCount * sizeof(unsigned int);
+    if (header.vertexCount == 0 ||
+        header.vertexOffset + vertexBytes > file.getSize() ||
+        header.indexOffset + indexBytes > file.getSize() ||
+        header.meshletOffset + header.meshletCount * sizeof(Meshlet) > file.getSize() ||
+        header.lodCount > MESH_CACHE_MAX_LODS)
+    {
+        LOG_ERROR("Mesh cache truncated: " << getCachePath(key));
+        return false;
+    }
+
+    entry.vertexData = file.getData() + header.vertexOffset;
+    entry.indexData = reinterpret_cast<const unsigned int *>(file.getData() + header.indexOffset);
+    entry.vertexCount = header.vertexCount;
+    entry.indexCount = header.indexCount;
+    entry.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    entry.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    entry.lods.assign(header.lods, header.lods + header.lodCount);
+    for (const MeshLod &lod : entry.lods)
+    {
+        if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > header.indexCount)
+        {
+            LOG_ERROR("Mesh cache LOD table corrupt: " << getCachePath(key));
+            return false;
+        }
+    }
+
+    // Meshlet ranges feed glMultiDrawElements offsets directly
+    const Meshlet *meshlets = reinterpret_cast<const Meshlet *>(file.getData() + header.meshletOffset);
+    entry.meshlets.assign(meshlets, meshlets + header.meshletCount);
+    for (const Meshlet &meshlet : entry.meshlets)
+    {
+        if (static_cast<uint64_t>(meshlet.indexOffset) + meshlet.indexCount > header.indexCount)
+        {
+            LOG_ERROR("Mesh cache meshlet table corrupt: " << getCachePath(key));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MeshCache::load(const MeshCacheKey &key, Mesh &mesh) const
+{
+    MappedFile file;
+    MappedEntry entry;
+    if (!mapEntry(key, file, entry))
+        return false;
+
+    // Hand the mapped pages directly to the driver
+    mesh.setVertexFormat(key.vertexFormat);
+    mesh.setBounds(entry.boundsMin, entry.boundsMax);
+    mesh.setLods(entry.lods);
+    mesh.setMeshlets(entry.meshlets);
+    mesh.uploadBuffers(entry.vertexData, entry.vertexCount, entry.indexData, entry.indexCount);
+    return true;
+}
+
+bool MeshCache::loadData(const MeshCacheKey &key, MeshData &data) const
+{
+    MappedFile file;
+    MappedEntry entry;
+    if (!mapEntry(key, file, entry))
+        return false;
+
+    data.vertexFormat = key.vertexFormat;
+    data.vertexCount = entry.vertexCount;
+    data.boundsMin = entry.boundsMin;
+    data.boundsMax = entry.boundsMax;
+    data.lods = entry.lods;
+    data.meshlets = entry.meshlets;
+    data.vertexData.assign(entry.vertexData, entry.vertexData + entry.vertexCount * Mesh::getVertexStride(key.vertexFormat));
+    data.indices.assign(entry.indexData, entry.indexData + entry.indexCount);
+    return true;
+}
+
+bool MeshCache::map(const MeshCacheKey &key, MappedMeshData &mapped) const
+{
+    MappedEntry entry;
+    if (!mapEntry(key, mapped.file, entry))
+    {
+        mapped.file.close();
+        return false;
+    }
+
+    mapped.layout = MeshData();
+    mapped.layout.vertexFormat = key.vertexFormat;
+    mapped.layout.vertexCount = entry.vertexCount;
+    mapped.layout.boundsMin = entry.boundsMin;
+    mapped.layout.boundsMax = entry.boundsMax;
+    mapped.layout.lods = entry.lods;
+    mapped.layout.meshlets = entry.meshlets;
+    mapped.vertexData = entry.vertexData;
+    mapped.indexData = entry.indexData;
+    mapped.indexCount = entry.indexCount;
+    return true;
+}
+
+bool MeshCache::store(const MeshCacheKey &key, const MeshData &data) const
+{
+    MeshCacheWriter writer;
+    if (!writer.open(*this, key) ||
+        !writer.writeVertices(data.vertexData.data(), data.vertexData.size()))
+    {
+        return false;
+    }
+    return writer.finish(data.vertexCount, data.boundsMin, data.boundsMax, data.indices.data(), data.indices.size(),
+                         data.lods, data.meshlets);
+}
+
+// MeshCacheWriter implementation
+MeshCacheWriter::MeshCacheWriter() : vertexBytes(0) {}
+
+MeshCacheWriter::~MeshCacheWriter()
+{
+    abort();
+}
+
+bool MeshCacheWriter::open(const MeshCache &cache, const MeshCacheKey &entryKey)
+{
+    abort();
+
+    key = entryKey;
+    path = cache.getCachePath(key);
+    tempPath = path + ".tmp";
+    vertexBytes = 0;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    out.open(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        LOG_ERROR("Failed to write mesh cache: " << tempPath);
+        return false;
+    }
+
+    // Reserve the header page; the header itself is written by finish()
+    std::vector<char> padding(alignOffset(sizeof(MeshCacheHeader)), 0);
+    out.write(padding.data(), padding.size());
+    return static_cast<bool>(out);
+}
+
+bool MeshCacheWriter::writeVertices(const void *data, size_t bytes)
+{
+    if (!out.is_open())
+        return false;
+
+    out.write(static_cast<const char *>(data), bytes);
+    vertexBytes += bytes;
+    return static_cast<bool>(out);
+}
+
+bool MeshCacheWriter::finish(size_t vertexCount, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax,
+                             const unsigned int *indices, size_t indexCount, const std::vector<MeshLod> &lods,
+                             const std::vector<Meshlet> &meshlets)
+{
+    if (!out.is_open())
+        return false;
+
+    if (lods.size() > MESH_CACHE_MAX_LODS)
+    {
+        LOG_ERROR("Mesh cache supports at most " << MESH_CACHE_MAX_LODS << " LODs: " << tempPath);
+        abort();
+        return false;
+    }
+
+    MeshCacheHeader header = {};
+    std::memcpy(header.magic, MESH_CACHE_MAGIC, 4);
+    header.version = MeshCache::VERSION;
+    header.vertexFormat = static_cast<uint32_t>(key.vertexFormat);
+    header.vertexStride = static_cast<uint32_t>(Mesh::getVertexStride(key.vertexFormat));
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.vertexOffset = alignOffset(sizeof(MeshCacheHeader));
+    header.indexOffset = alignOffset(header.vertexOffset + vertexBytes);
+    header.meshletCount = meshlets.size();
+    header.meshletOffset = alignOffset(header.indexOffset + indexCount * sizeof(unsigned int));
+    header.sourceSize = key.sourceSize;
+    header.sourceMtime = key.sourceMtime;
+    header.contentHash = key.contentHash;
+    header.pathHash = hashBytes(key.sourcePath.data(), key.sourcePath.size());
+    header.processingHash = key.processingHash;
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    std::copy(lods.begin(), lods.end(), header.lods);
+    for (int i = 0; i < 3; i++)
+    {
+        header.boundsMin[i] = boundsMin[i];
+        header.boundsMax[i] = boundsMax[i];
+    }
+
+    if (vertexBytes != vertexCount * header.vertexStride)
+    {
+        LOG_ERROR("Mesh cache vertex data size mismatch: " << tempPath);
+        abort();
+        return false;
+    }
+
+    std::vector<char> padding(MESH_CACHE_ALIGNMENT, 0);
+    out.write(padding.data(), header.indexOffset - (header.vertexOffset + vertexBytes));
+    out.write(reinterpret_cast<const char *>(indices), indexCount * sizeof(unsigned int));
+    out.write(padding.data(), header.meshletOffset - (header.indexOffset + indexCount * sizeof(unsigned int)));
+    out.write(reinterpret_cast<const char *>(meshlets.data()), meshlets.size() * sizeof(Meshlet));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+
+    std::error_code ec;
+    if (!out)
+    {
+        LOG_ERROR("Failed to write mesh cache: " << tempPath);
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    // Atomic replace so a crash never leaves a half-written entry behind
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        LOG_ERROR("Failed to finalize mesh cache: " << path);
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    LOG_INFO("Wrote mesh cache: " << path);
+    return true;
+}
+
+void MeshCacheWriter::abort()
+{
+    if (!out.is_open())
+        return;
+
+    out.close();
+    std::error_code ec;
+    std::filesystem::remove(tempPath, ec);
+}
@@ -0,0 +1,378 @@
+#include "motion/MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <utility>
+
+// Symmetric 4x4 quadric stored as its upper triangle
+struct Quadric
+{
+    double a[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    void addPlane(const glm::vec3 &n, float d, double weight)
+    {
+        double nx = n.x, ny = n.y, nz = n.z, nd = d;
+        a[0] += weight * nx * nx; a[1] += weight * nx * ny; a[2] += weight * nx * nz; a[3] += weight * nx * nd;
+        a[4] += weight * ny * ny; a[5] += weight * ny * nz; a[6] += weight * ny * nd;
+        a[7] += weight * nz * nz; a[8] += weight * nz * nd;
+        a[9] += weight * nd * nd;
+    }
+
+    void add(const Quadric &q)
+    {
+        for (int i = 0; i < 10; i++)
+            a[i] += q.a[i];
+    }
+
+    double evaluate(const glm::vec3 &p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x +
+               a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y +
+               a[7] * z * z + 2 * a[8] * z +
+               a[9];
+    }
+};
+
+// Candidate half-edge collapse, invalidated lazily through vertex versions
+struct Collapse
+{
+    float cost;
+    uint32_t from, to;
+    uint32_t fromVersion, toVersion;
+
+    bool operator>(const Collapse &other) const { return cost > other.cost; }
+};
+
+static uint64_t hashFloats(const float *values, size_t count)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        hash ^= bits;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Open-addressing map from stride-float keys to the first vertex holding them
+static std::vector<unsigned int> findUniqueVertices(const float *data, size_t stride, size_t keyFloats,
+                                                    size_t vertexCount, std::vector<unsigned int> &remap)
+{
+    size_t capacity = 1;
+    while (capacity < vertexCount * 2)
+        capacity <<= 1;
+
+    const unsigned int EMPTY = ~0u;
+    std::vector<unsigned int> table(capacity, EMPTY);
+    std::vector<unsigned int> unique;
+    remap.resize(vertexCount);
+
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        const float *key = data + v * stride;
+        size_t slot = hashFloats(key, keyFloats) & (capacity - 1);
+        while (true)
+        {
+            unsigned int entry = table[slot];
+            if (entry == EMPTY)
+            {
+                table[slot] = static_cast<unsigned int>(unique.size());
+                remap[v] = static_cast<unsigned int>(unique.size());
+                unique.push_back(static_cast<unsigned int>(v));
+                break;
+            }
+            if (std::memcmp(data + unique[entry] * stride, key, keyFloats * sizeof(float)) == 0)
+            {
+                remap[v] = entry;
+                break;
+            }
+            slot = (slot + 1) & (capacity - 1);
+        }
+    }
+    return unique;
+}
+
+std::vector<unsigned int> MeshSimplifier::weldVertices(std::vector<float> &vertices, size_t stride)
+{
+    size_t vertexCount = vertices.size() / stride;
+    std::vector<unsigned int> indices;
+    std::vector<unsigned int> unique = findUniqueVertices(vertices.data(), stride, stride, vertexCount, indices);
+
+    // Compact in place; unique[i] >= i so nothing is overwritten before it is read
+    for (size_t i = 0; i < unique.size(); i++)
+    {
+        if (unique[i] != i)
+            std::memcpy(&vertices[i * stride], &vertices[unique[i] * stride], stride * sizeof(float));
+    }
+    vertices.resize(unique.size() * stride);
+    return indices;
+}
+
+static glm::vec3 triangleNormal(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2)
+{
+    return glm::cross(p1 - p0, p2 - p0);
+}
+
+std::vector<unsigned int> MeshSimplifier::simplify(const float *positions, size_t stride, size_t vertexCount,
+                                                   const std::vector<unsigned int> &indices, size_t targetTriangles,
+                                                   float &resultError)
+{
+    resultError = 0.0f;
+
+    // Collapse topology on positions so seams in normals/UVs do not split the surface
+    std::vector<unsigned int> positionOf;
+    std::vector<unsigned int> representative = findUniqueVertices(positions, stride, 3, vertexCount, positionOf);
+    size_t positionCount = representative.size();
+
+    std::vector<glm::vec3> points(positionCount);
+    for (size_t i = 0; i < positionCount; i++)
+    {
+        const float *p = positions + representative[i] * stride;
+        points[i] = glm::vec3(p[0], p[1], p[2]);
+    }
+
+    // Triangles in position space, dropping ones that are already degenerate.
+    // wedges keeps the original vertex behind each corner so normals and UVs
+    // survive across seams
+    std::vector<uint32_t> tris, wedges;
+    tris.reserve(indices.size());
+    wedges.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t a = positionOf[indices[i]], b = positionOf[indices[i + 1]], c = positionOf[indices[i + 2]];
+        if (a != b && b != c && a != c)
+        {
+            tris.insert(tris.end(), {a, b, c});
+            wedges.insert(wedges.end(), {indices[i], indices[i + 1], indices[i + 2]});
+        }
+    }
+    size_t triangleCount = tris.size() / 3;
+    size_t liveTriangles = triangleCount;
+    std::vector<bool> triangleAlive(triangleCount, true);
+
+    // Per-vertex corner lists as flat linked lists: corner c = 3 * triangle + k
+    const uint32_t NONE = ~0u;
+    std::vector<uint32_t> cornerHead(positionCount, NONE), cornerNext(tris.size(), NONE);
+    for (uint32_t c = 0; c < tris.size(); c++)
+    {
+        cornerNext[c] = cornerHead[tris[c]];
+        cornerHead[tris[c]] = c;
+    }
+
+    // Face quadrics
+    std::vector<Quadric> quadrics(positionCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const glm::vec3 &p0 = points[tris[t * 3]];
+        glm::vec3 n = triangleNormal(p0, points[tris[t * 3 + 1]], points[tris[t * 3 + 2]]);
+        float len = glm::length(n);
+        if (len <= 0.0f)
+            continue;
+        n /= len;
+        float d = -glm::dot(n, p0);
+        for (int k = 0; k < 3; k++)
+            quadrics[tris[t * 3 + k]].addPlane(n, d, 1.0);
+    }
+
+    // Boundary edges (used by one triangle) get a perpendicular constraint plane
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(tris.size());
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint64_t a = tris[t * 3 + k], b = tris[t * 3 + (k + 1) % 3];
+                edges.push_back(std::min(a, b) << 32 | std::max(a, b));
+            }
+        }
+        std::vector<uint64_t> sorted = edges;
+        std::sort(sorted.begin(), sorted.end());
+
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                uint64_t key = edges[t * 3 + k];
+                auto range = std::equal_range(sorted.begin(), sorted.end(), key);
+                if (range.second - range.first != 1)
+                    continue;
+
+                uint32_t a = tris[t * 3 + k], b = tris[t * 3 + (k + 1) % 3];
+                glm::vec3 faceNormal = triangleNormal(points[tris[t * 3]], points[tris[t * 3 + 1]], points[tris[t * 3 + 2]]);
+                glm::vec3 n = glm::cross(points[b] - points[a], faceNormal);
+                float len = glm::length(n);
+                if (len <= 0.0f)
+                    continue;
+                n /= len;
+                float d = -glm::dot(n, points[a]);
+                quadrics[a].addPlane(n, d, 10.0);
+                quadrics[b].addPlane(n, d, 10.0);
+            }
+        }
+    }
+
+    std::vector<uint32_t> version(positionCount, 0);
+    std::vector<bool> vertexAlive(positionCount, true);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+    std::vector<std::pair<uint32_t, uint32_t>> wedgeMoves;
+
+    auto pushEdge = [&](uint32_t a, uint32_t b)
+    {
+        Quadric q = quadrics[a];
+        q.add(quadrics[b]);
+        double toB = std::max(q.evaluate(points[b]), 0.0);
+        double toA = std::max(q.evaluate(points[a]), 0.0);
+
+        // Flat regions cost nothing; prefer short edges there so collapses spread
+        // out instead of piling onto one high-valence vertex
+        glm::vec3 edge = points[b] - points[a];
+        float tieBreak = 1e-6f * glm::dot(edge, edge);
+        if (toB <= toA)
+            heap.push({static_cast<float>(toB) + tieBreak, a, b, version[a], version[b]});
+        else
+            heap.push({static_cast<float>(toA) + tieBreak, b, a, version[b], version[a]});
+    };
+
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t a = tris[t * 3 + k], b = tris[t * 3 + (k + 1) % 3];
+            if (a < b)
+                pushEdge(a, b);
+        }
+    }
+
+    while (liveTriangles > targetTriangles && !heap.empty())
+    {
+        Collapse collapse = heap.top();
+        heap.pop();
+
+        uint32_t from = collapse.from, to = collapse.to;
+        if (!vertexAlive[from] || !vertexAlive[to] ||
+            version[from] != collapse.fromVersion || version[to] != collapse.toVersion)
+            continue;
+
+        // Reject collapses that flip or degenerate a surviving triangle
+        bool valid = true;
+        for (uint32_t c = cornerHead[from]; c != NONE && valid; c = cornerNext[c])
+        {
+            uint32_t t = c / 3;
+            if (!triangleAlive[t])
+                continue;
+
+            uint32_t *tri = &tris[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;
+
+            glm::vec3 before = triangleNormal(points[tri[0]], points[tri[1]], points[tri[2]]);
+            glm::vec3 moved[3];
+            for (int k = 0; k < 3; k++)
+                moved[k] = points[tri[k] == from ? to : tri[k]];
+            glm::vec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+            valid = glm::dot(before, after) > 0.0f;
+        }
+        if (!valid)
+            continue;
+
+        // Triangles on the collapsed edge tell which wedge at to continues each
+        // wedge at from; corners on the same side of a seam follow that pairing
+        wedgeMoves.clear();
+        for (uint32_t c = cornerHead[from]; c != NONE; c = cornerNext[c])
+        {
+            uint32_t t = c / 3;
+            if (!triangleAlive[t])
+                continue;
+            for (int k = 0; k < 3; k++)
+            {
+                if (tris[t * 3 + k] == to)
+                    wedgeMoves.push_back({wedges[c], wedges[t * 3 + k]});
+            }
+        }
+
+        // Apply: retarget corners, kill triangles that contained the edge
+        uint32_t tail = NONE;
+        for (uint32_t c = cornerHead[from]; c != NONE; c = cornerNext[c])
+        {
+            tail = c;
+            uint32_t t = c / 3;
+            if (!triangleAlive[t])
+                continue;
+
+            uint32_t *tri = &tris[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+            {
+                triangleAlive[t] = false;
+                liveTriangles--;
+            }
+            else
+            {
+                // A wedge with no edge triangle of its own (from sits on a seam
+                // the edge does not cross) takes the first wedge at to
+                uint32_t wedge = wedgeMoves.empty() ? representative[to] : wedgeMoves.front().second;
+                for (const auto &move : wedgeMoves)
+                {
+                    if (move.first == wedges[c])
+                    {
+                        wedge = move.second;
+                        break;
+                    }
+                }
+                tris[c] = to;
+                wedges[c] = wedge;
+            }
+        }
+        if (tail != NONE)
+        {
+            cornerNext[tail] = cornerHead[to];
+            cornerHead[to] = cornerHead[from];
+            cornerHead[from] = NONE;
+        }
+
+        quadrics[to].add(quadrics[from]);
+        vertexAlive[from] = false;
+        version[to]++;
+        resultError = std::max(resultError, collapse.cost);
+
+        // Re-queue the edges around the merged vertex, unlinking dead corners
+        uint32_t *link = &cornerHead[to];
+        while (*link != NONE)
+        {
+            uint32_t c = *link;
+            uint32_t t = c / 3;
+            if (!triangleAlive[t])
+            {
+                *link = cornerNext[c];
+                continue;
+            }
+            link = &cornerNext[c];
+
+            for (int k = 0; k < 3; k++)
+            {
+                uint32_t other = tris[t * 3 + k];
+                if (other != to)
+                    pushEdge(to, other);
+            }
+        }
+    }
+
+    resultError = std::sqrt(resultError);
+
+    // Surviving triangles keep the original vertex of each corner
+    std::vector<unsigned int> result;
+    result.reserve(liveTriangles * 3);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        if (!triangleAlive[t])
+            continue;
+        for (int k = 0; k < 3; k++)
+            result.push_back(wedges[t * 3 + k]);
+    }
+    return result;
+}
@@ -0,0 +1,226 @@
+#include "motion/Meshlet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+void MeshletBuilder::build(const float *positions, size_t stride, std::vector<unsigned int> &indices,
+                           size_t firstIndex, size_t indexCount, std::vector<Meshlet> &meshlets)
+{
+    const unsigned int *tris = indices.data() + firstIndex;
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    size_t vertexCount = *std::max_element(tris, tris + triangleCount * 3) + 1;
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<uint32_t> adjacencyStart(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        adjacencyStart[tris[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        adjacencyStart[v + 1] += adjacencyStart[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            adjacency[fill[tris[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    auto position = [&](unsigned int v)
+    {
+        const float *p = positions + v * stride;
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    const uint32_t NONE = ~0u;
+    std::vector<bool> used(triangleCount, false);
+    std::vector<uint32_t> vertexStamp(vertexCount, NONE);
+    std::vector<unsigned int> ordered;
+    ordered.reserve(triangleCount * 3);
+
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> meshletTriangles;
+    std::vector<unsigned int> meshletVertices;
+    size_t cursor = 0;
+
+    while (true)
+    {
+        while (cursor < triangleCount && used[cursor])
+            cursor++;
+        if (cursor == triangleCount)
+            break;
+
+        uint32_t stamp = static_cast<uint32_t>(meshlets.size());
+        candidates.clear();
+        meshletTriangles.clear();
+        meshletVertices.clear();
+
+        auto addTriangle = [&](uint32_t t)
+        {
+            used[t] = true;
+            meshletTriangles.push_back(t);
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int v = tris[t * 3 + k];
+                if (vertexStamp[v] == stamp)
+                    continue;
+                vertexStamp[v] = stamp;
+                meshletVertices.push_back(v);
+                for (uint32_t a = adjacencyStart[v]; a < adjacencyStart[v + 1]; a++)
+                {
+                    if (!used[adjacency[a]])
+                        candidates.push_back(adjacency[a]);
+                }
+            }
+        };
+
+        addTriangle(static_cast<uint32_t>(cursor));
+
+        // Grow over shared vertices, preferring triangles that add the fewest new ones
+        while (meshletTriangles.size() < MAX_TRIANGLES)
+        {
+            uint32_t best = NONE;
+            int bestNew = 4;
+            for (size_t c = 0; c < candidates.size();)
+            {
+                uint32_t t = candidates[c];
+                if (used[t])
+                {
+                    candidates[c] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+
+                int newVertices = 0;
+                for (int k = 0; k < 3; k++)
+                    newVertices += vertexStamp[tris[t * 3 + k]] != stamp;
+
+                if (newVertices < bestNew && meshletVertices.size() + newVertices <= MAX_VERTICES)
+                {
+                    best = t;
+                    bestNew = newVertices;
+                    if (newVertices == 0)
+                        break;
+                }
+                c++;
+            }
+
+            if (best == NONE)
+                break;
+            addTriangle(best);
+        }
+
+        Meshlet meshlet;
+        meshlet.indexOffset = static_cast<unsigned int>(firstIndex + ordered.size());
+        meshlet.indexCount = static_cast<unsigned int>(meshletTriangles.size() * 3);
+
+        // Bounding sphere around the AABB center
+        glm::vec3 boundsMin = position(meshletVertices[0]);
+        glm::vec3 boundsMax = boundsMin;
+        for (unsigned int v : meshletVertices)
+        {
+            boundsMin = glm::min(boundsMin, position(v));
+            boundsMax = glm::max(boundsMax, position(v));
+        }
+        meshlet.center = (boundsMin + boundsMax) * 0.5f;
+        meshlet.radius = 0.0f;
+        for (unsigned int v : meshletVertices)
+            meshlet.radius = std::max(meshlet.radius, glm::length(position(v) - meshlet.center));
+
+        // Normal cone from the unit face normals
+        glm::vec3 normalSum(0.0f);
+        std::vector<glm::vec3> normals;
+        normals.reserve(meshletTriangles.size());
+        for (uint32_t t : meshletTriangles)
+        {
+            glm::vec3 p0 = position(tris[t * 3]);
+            glm::vec3 n = glm::cross(position(tris[t * 3 + 1]) - p0, position(tris[t * 3 + 2]) - p0);
+            float len = glm::length(n);
+            if (len > 0.0f)
+            {
+                normals.push_back(n / len);
+                normalSum += n / len;
+            }
+        }
+
+        meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.coneCutoff = 1.0f;
+        float axisLength = glm::length(normalSum);
+        if (axisLength > 0.0f)
+        {
+            meshlet.coneAxis = normalSum / axisLength;
+            float minDot = 1.0f;
+            for (const glm::vec3 &n : normals)
+                minDot = std::min(minDot, glm::dot(n, meshlet.coneAxis));
+
+            // Cones wider than a hemisphere can never be entirely back facing
+            if (minDot > 0.0f)
+                meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+
+        for (uint32_t t : meshletTriangles)
+            ordered.insert(ordered.end(), {tris[t * 3], tris[t * 3 + 1], tris[t * 3 + 2]});
+        meshlets.push_back(meshlet);
+    }
+
+    std::copy(ordered.begin(), ordered.end(), indices.begin() + firstIndex);
+}
+
+void MeshletBuilder::cull(const std::vector<Meshlet> &meshlets, const glm::vec4 planes[6], const glm::vec3 &camera,
+                          std::vector<int> &counts, std::vector<const void *> &offsets, MeshletCullStats &stats)
+{
+    counts.clear();
+    offsets.clear();
+    stats = MeshletCullStats();
+    stats.total = meshlets.size();
+
+    unsigned int rangeEnd = ~0u;
+    for (const Meshlet &meshlet : meshlets)
+    {
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; p++)
+            outside = glm::dot(glm::vec3(planes[p]), meshlet.center) + planes[p].w < -meshlet.radius;
+        if (outside)
+        {
+            stats.frustumCulled++;
+            continue;
+        }
+
+        glm::vec3 toCenter = meshlet.center - camera;
+        if (glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+        {
+            stats.backfaceCulled++;
+            continue;
+        }
+
+        if (meshlet.indexOffset == rangeEnd)
+        {
+            counts.back() += meshlet.indexCount;
+        }
+        else
+        {
+            counts.push_back(static_cast<int>(meshlet.indexCount));
+            offsets.push_back(reinterpret_cast<const void *>(meshlet.indexOffset * sizeof(unsigned int)));
+        }
+        rangeEnd = meshlet.indexOffset + meshlet.indexCount;
+    }
+    stats.drawRanges = counts.size();
+}
+
+void MeshletBuilder::extractFrustumPlanes(const glm::mat4 &m, glm::vec4 planes[6])
+{
+    // Gribb-Hartmann: clip-space planes are sums/differences of the matrix rows
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++)
+        rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+
+    planes[0] = rows[3] + rows[0]; // Left
+    planes[1] = rows[3] - rows[0]; // Right
+    planes[2] = rows[3] + rows[1]; // Bottom
+    planes[3] = rows[3] - rows[1]; // Top
+    planes[4] = rows[3] + rows[2]; // Near
+    planes[5] = rows[3] - rows[2]; // Far
+
+    for (int p = 0; p < 6; p++)
+        planes[p] = planes[p] / glm::length(glm::vec3(planes[p]));
+}
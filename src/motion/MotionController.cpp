@@ -1,4 +1,5 @@
 #include "motion/MotionController.h"
+#include "motion/Profiler.h"
 #include <algorithm>
 #include <iostream>
 #include <cmath>
@@ -21,6 +22,7 @@ KeyFrame::KeyFrame(glm::vec3 pos, glm::quat quat, float t)
 // OptimizedMotionController implementation
 void OptimizedMotionController::precomputeSegments() const {
     if (segmentsCached || keyframes.size() < 2) return;
+    PROFILE_SCOPE("precomputeSegments");
     
     segments.clear();
     segments.reserve(keyframes.size() - 1);
@@ -172,6 +174,8 @@ void OptimizedMotionController::clearKeyFrames() {
 }
 
 glm::mat4 OptimizedMotionController::getTransformationMatrix(float time, bool useQuat, bool useBSplines) const {
+    PROFILE_SCOPE("getTransformationMatrix");
+
     // Early return for empty keyframes
     if (keyframes.empty()) return glm::mat4(1.0f);
     
@@ -0,0 +1,404 @@
+#include "motion/OBJLoader.h"
+#include "motion/Logger.h"
+#include "motion/Profiler.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+static glm::vec3 calculateNormal(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2)
+{
+    glm::vec3 edge1 = v1 - v0;
+    glm::vec3 edge2 = v2 - v0;
+    return glm::normalize(glm::cross(edge1, edge2));
+}
+
+// OBJ parsing helpers shared by loadOBJ and streamOBJ
+struct OBJCorner
+{
+    long v, vt, vn; // 1-based or negative (relative), 0 when absent
+};
+
+static const char *skipSpaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t')
+        p++;
+    return p;
+}
+
+static bool parseCorner(const char *&p, OBJCorner &corner)
+{
+    char *end;
+    corner.v = std::strtol(p, &end, 10);
+    if (end == p)
+        return false;
+    p = end;
+    corner.vt = corner.vn = 0;
+
+    if (*p == '/')
+    {
+        p++;
+        if (*p != '/')
+        {
+            corner.vt = std::strtol(p, &end, 10);
+            p = end;
+        }
+        if (*p == '/')
+        {
+            p++;
+            corner.vn = std::strtol(p, &end, 10);
+            p = end;
+        }
+    }
+    return true;
+}
+
+// Resolve a 1-based or relative OBJ index into [0, count); -1 if invalid
+static long resolveIndex(long index, size_t count)
+{
+    long resolved = index > 0 ? index - 1 : static_cast<long>(count) + index;
+    return (index != 0 && resolved >= 0 && resolved < static_cast<long>(count)) ? resolved : -1;
+}
+
+// 0-based index for a 1-based or relative OBJ index; -1 when absent.
+// Positive indices are checked later, so faces may refer ahead.
+static int toZeroBased(long index, size_t count)
+{
+    long resolved = index > 0 ? index - 1 : (index < 0 ? static_cast<long>(count) + index : -1);
+    return resolved >= 0 ? static_cast<int>(resolved) : -1;
+}
+
+static bool inRange(int index, size_t count)
+{
+    return index >= 0 && static_cast<size_t>(index) < count;
+}
+
+bool OBJLoader::parse(const std::string &path, OBJData &out)
+{
+    PROFILE_SCOPE("OBJLoader::parse");
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        LOG_ERROR("Failed to open OBJ file: " << path);
+        return false;
+    }
+
+    out = OBJData();
+
+    std::string line;
+    OBJCorner corner;
+    while (std::getline(file, line))
+    {
+        const char *p = skipSpaces(line.c_str());
+        char *end;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            glm::vec3 v;
+            v.x = std::strtof(p + 2, &end);
+            v.y = std::strtof(end, &end);
+            v.z = std::strtof(end, &end);
+            out.positions.push_back(v);
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            glm::vec2 uv;
+            uv.x = std::strtof(p + 2, &end);
+            uv.y = std::strtof(end, &end);
+            out.uvs.push_back(uv);
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            glm::vec3 n;
+            n.x = std::strtof(p + 2, &end);
+            n.y = std::strtof(end, &end);
+            n.z = std::strtof(end, &end);
+            out.normals.push_back(n);
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            size_t first = out.corners.size();
+            for (p = skipSpaces(p + 2); *p && parseCorner(p, corner); p = skipSpaces(p))
+            {
+                out.corners.push_back({toZeroBased(corner.v, out.positions.size()),
+                                       toZeroBased(corner.vt, out.uvs.size()),
+                                       toZeroBased(corner.vn, out.normals.size())});
+            }
+            if (out.corners.size() > first)
+                out.faceEnds.push_back(static_cast<unsigned int>(out.corners.size()));
+        }
+    }
+
+    if (out.positions.empty())
+    {
+        LOG_ERROR("No vertices found in OBJ file");
+        return false;
+    }
+    return true;
+}
+
+void OBJLoader::triangulate(OBJData &obj)
+{
+    PROFILE_SCOPE("OBJLoader::triangulate");
+    size_t triangleCount = 0;
+    unsigned int start = 0;
+    for (unsigned int end : obj.faceEnds)
+    {
+        if (end - start >= 3)
+            triangleCount += end - start - 2;
+        start = end;
+    }
+
+    obj.triangles.clear();
+    obj.triangles.reserve(triangleCount * 3);
+
+    // Fan around the first corner; faces are assumed convex
+    start = 0;
+    for (unsigned int end : obj.faceEnds)
+    {
+        for (unsigned int i = start + 1; i + 1 < end; i++)
+        {
+            if (inRange(obj.corners[start].position, obj.positions.size()) &&
+                inRange(obj.corners[i].position, obj.positions.size()) &&
+                inRange(obj.corners[i + 1].position, obj.positions.size()))
+                obj.triangles.insert(obj.triangles.end(), {start, i, i + 1});
+        }
+        start = end;
+    }
+}
+
+void OBJLoader::expand(const OBJData &obj, std::vector<float> &vertices)
+{
+    PROFILE_SCOPE("OBJLoader::expand");
+    vertices.resize(obj.triangles.size() * 8);
+    float *out = vertices.data();
+    for (size_t t = 0; t < obj.triangles.size(); t += 3)
+    {
+        const OBJIndex *tri[3] = {&obj.corners[obj.triangles[t]], &obj.corners[obj.triangles[t + 1]],
+                                  &obj.corners[obj.triangles[t + 2]]};
+
+        glm::vec3 faceNormal(0.0f);
+        if (!inRange(tri[0]->normal, obj.normals.size()) || !inRange(tri[1]->normal, obj.normals.size()) ||
+            !inRange(tri[2]->normal, obj.normals.size()))
+            faceNormal = calculateNormal(obj.positions[tri[0]->position], obj.positions[tri[1]->position],
+                                         obj.positions[tri[2]->position]);
+
+        for (int j = 0; j < 3; j++)
+        {
+            const glm::vec3 &position = obj.positions[tri[j]->position];
+            const glm::vec3 &normal = inRange(tri[j]->normal, obj.normals.size()) ? obj.normals[tri[j]->normal]
+                                                                                  : faceNormal;
+            glm::vec2 uv = inRange(tri[j]->uv, obj.uvs.size()) ? obj.uvs[tri[j]->uv] : glm::vec2(0.0f);
+
+            out[0] = position.x;
+            out[1] = position.y;
+            out[2] = position.z;
+            out[3] = normal.x;
+            out[4] = normal.y;
+            out[5] = normal.z;
+            out[6] = uv.x;
+            out[7] = uv.y;
+            out += 8;
+        }
+    }
+}
+
+bool OBJLoader::loadOBJ(const std::string &path, std::vector<float> &vertices)
+{
+    PROFILE_SCOPE("loadOBJ");
+    OBJData obj;
+    if (!parse(path, obj))
+        return false;
+    triangulate(obj);
+    expand(obj, vertices);
+
+    LOG_INFO("Loaded OBJ file: " << path);
+    LOG_INFO("Vertices: " << obj.positions.size());
+    LOG_INFO("Faces: " << obj.triangles.size() / 3);
+    LOG_INFO("Has normals: " << (obj.normals.empty() ? "No (calculated)" : "Yes"));
+    LOG_INFO("Has UVs: " << (obj.uvs.empty() ? "No" : "Yes"));
+    return true;
+}
+
+bool OBJLoader::streamOBJ(const std::string &path, VertexFormat format, size_t memoryBudget,
+                          const VertexChunkSink &sink, OBJStreamStats &stats)
+{
+    PROFILE_SCOPE("streamOBJ");
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        LOG_ERROR("Failed to open OBJ file: " << path);
+        return false;
+    }
+
+    // Pass 1: count attributes and triangles and find the bounds, storing nothing
+    size_t positionCount = 0, uvCount = 0, normalCount = 0, triangleCount = 0;
+    glm::vec3 boundsMin(0.0f), boundsMax(0.0f);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const char *p = skipSpaces(line.c_str());
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            char *end;
+            glm::vec3 v;
+            v.x = std::strtof(p + 2, &end);
+            v.y = std::strtof(end, &end);
+            v.z = std::strtof(end, &end);
+            boundsMin = positionCount == 0 ? v : glm::min(boundsMin, v);
+            boundsMax = positionCount == 0 ? v : glm::max(boundsMax, v);
+            positionCount++;
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            uvCount++;
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            normalCount++;
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            size_t corners = 0;
+            for (p = skipSpaces(p + 2); *p && *p != '\r' && *p != '#'; p = skipSpaces(p))
+            {
+                while (*p && *p != ' ' && *p != '\t' && *p != '\r')
+                    p++;
+                corners++;
+            }
+            if (corners >= 3)
+                triangleCount += corners - 2;
+        }
+    }
+
+    if (positionCount == 0)
+    {
+        LOG_ERROR("No vertices found in OBJ file");
+        return false;
+    }
+
+    // Size the flat arenas exactly and check them against the budget
+    const size_t minChunkBytes = 64 * 1024;
+    const size_t maxChunkBytes = 16 * 1024 * 1024;
+    size_t stride = vertexStride(format);
+    size_t arenaBytes = (positionCount * 3 + uvCount * 2 + normalCount * 3) * sizeof(float);
+    if (arenaBytes + minChunkBytes > memoryBudget)
+    {
+        LOG_ERROR("OBJ attributes need " << (arenaBytes >> 20) << " MB, over the "
+                  << (memoryBudget >> 20) << " MB streaming budget: " << path);
+        return false;
+    }
+    size_t chunkBytes = std::min(memoryBudget - arenaBytes, maxChunkBytes) / stride * stride;
+    size_t expectedBytes = triangleCount * 3 * stride; // Upper bound if faces are skipped
+
+    std::vector<float> positions, uvs, normals;
+    positions.reserve(positionCount * 3);
+    uvs.reserve(uvCount * 2);
+    normals.reserve(normalCount * 3);
+    std::vector<unsigned char> chunk(chunkBytes);
+    size_t chunkUsed = 0;
+
+    stats = OBJStreamStats();
+    stats.boundsMin = boundsMin;
+    stats.boundsMax = boundsMax;
+    stats.arenaBytes = arenaBytes + chunkBytes;
+
+    glm::vec3 quantScale = quantizationScale(boundsMin, boundsMax);
+    std::vector<OBJCorner> corners;
+
+    // Pass 2: fill the arenas and emit expanded triangles as faces arrive
+    file.clear();
+    file.seekg(0);
+    while (std::getline(file, line))
+    {
+        const char *p = skipSpaces(line.c_str());
+        char *end;
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            float x = std::strtof(p + 2, &end);
+            float y = std::strtof(end, &end);
+            float z = std::strtof(end, &end);
+            positions.insert(positions.end(), {x, y, z});
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            float u = std::strtof(p + 2, &end);
+            float v = std::strtof(end, &end);
+            uvs.insert(uvs.end(), {u, v});
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            float x = std::strtof(p + 2, &end);
+            float y = std::strtof(end, &end);
+            float z = std::strtof(end, &end);
+            normals.insert(normals.end(), {x, y, z});
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            corners.clear();
+            OBJCorner corner;
+            for (p = skipSpaces(p + 2); *p && parseCorner(p, corner); p = skipSpaces(p))
+                corners.push_back(corner);
+
+            // Triangulate as a fan, like loadOBJ
+            for (size_t i = 1; i + 1 < corners.size(); i++)
+            {
+                const OBJCorner *tri[3] = {&corners[0], &corners[i], &corners[i + 1]};
+                long vIdx[3];
+                bool valid = true;
+                for (int j = 0; j < 3; j++)
+                {
+                    vIdx[j] = resolveIndex(tri[j]->v, positions.size() / 3);
+                    valid = valid && vIdx[j] >= 0;
+                }
+                if (!valid)
+                    continue;
+
+                glm::vec3 faceNormal = calculateNormal(
+                    glm::vec3(positions[vIdx[0] * 3], positions[vIdx[0] * 3 + 1], positions[vIdx[0] * 3 + 2]),
+                    glm::vec3(positions[vIdx[1] * 3], positions[vIdx[1] * 3 + 1], positions[vIdx[1] * 3 + 2]),
+                    glm::vec3(positions[vIdx[2] * 3], positions[vIdx[2] * 3 + 1], positions[vIdx[2] * 3 + 2]));
+
+                for (int j = 0; j < 3; j++)
+                {
+                    float vertex[8];
+                    std::memcpy(vertex, &positions[vIdx[j] * 3], 3 * sizeof(float));
+
+                    long nIdx = resolveIndex(tri[j]->vn, normals.size() / 3);
+                    if (nIdx >= 0)
+                        std::memcpy(vertex + 3, &normals[nIdx * 3], 3 * sizeof(float));
+                    else
+                        std::memcpy(vertex + 3, &faceNormal, 3 * sizeof(float));
+
+                    long uvIdx = resolveIndex(tri[j]->vt, uvs.size() / 2);
+                    vertex[6] = uvIdx >= 0 ? uvs[uvIdx * 2] : 0.0f;
+                    vertex[7] = uvIdx >= 0 ? uvs[uvIdx * 2 + 1] : 0.0f;
+
+                    if (format == VertexFormat::Compact)
+                        packCompactVertex(vertex, boundsMin, quantScale, *reinterpret_cast<CompactVertex *>(&chunk[chunkUsed]));
+                    else
+                        std::memcpy(&chunk[chunkUsed], vertex, sizeof(vertex));
+                    chunkUsed += stride;
+
+                    if (chunkUsed == chunk.size())
+                    {
+                        if (!sink(chunk.data(), chunkUsed, expectedBytes))
+                            return false;
+                        chunkUsed = 0;
+                    }
+                }
+                stats.vertexCount += 3;
+                stats.triangleCount++;
+            }
+        }
+    }
+
+    if (chunkUsed > 0 && !sink(chunk.data(), chunkUsed, expectedBytes))
+        return false;
+
+    LOG_INFO("Streamed OBJ file: " << path);
+    LOG_INFO("Vertices: " << positionCount);
+    LOG_INFO("Faces: " << stats.triangleCount);
+    LOG_INFO("Streaming memory: " << (stats.arenaBytes >> 10) << " KB arenas and chunk (budget "
+             << (memoryBudget >> 10) << " KB)");
+    return true;
+}
+
@@ -0,0 +1,177 @@
+#include "motion/Profiler.h"
+#include "motion/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+// Single-producer ring: only the owning thread writes, and publishes each
+// event by advancing written with release order
+struct ThreadBuffer
+{
+    Profiler::Event events[Profiler::EVENTS_PER_THREAD];
+    std::atomic<uint64_t> written{0}; // Events ever recorded; the next goes to written % capacity
+    int id = 0;
+    std::string name; // Guarded by the registry mutex
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; // Kept after their threads exit
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+thread_local ThreadBuffer *threadBuffer = nullptr;
+
+ThreadBuffer *registerThread()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.buffers.emplace_back(new ThreadBuffer());
+    threadBuffer = reg.buffers.back().get();
+    threadBuffer->id = static_cast<int>(reg.buffers.size());
+    threadBuffer->name = "thread " + std::to_string(threadBuffer->id);
+    return threadBuffer;
+}
+
+// Copy out the events that are stable: read the count, copy, then drop any
+// the owner may have overwritten during the copy
+void snapshot(const ThreadBuffer &buffer, std::vector<Profiler::Event> &out)
+{
+    const uint64_t capacity = Profiler::EVENTS_PER_THREAD;
+    uint64_t end = buffer.written.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+
+    std::vector<Profiler::Event> copy;
+    copy.reserve(end - begin);
+    for (uint64_t i = begin; i < end; i++)
+        copy.push_back(buffer.events[i % capacity]);
+
+    uint64_t after = buffer.written.load(std::memory_order_acquire);
+    uint64_t firstIntact = after > capacity ? after - capacity : 0;
+    size_t skip = firstIntact > begin ? static_cast<size_t>(std::min(firstIntact - begin, end - begin)) : 0;
+    out.assign(copy.begin() + skip, copy.end());
+}
+
+void writeQuoted(FILE *file, const char *text)
+{
+    std::fputc('"', file);
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            std::fputc('\\', file);
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+} // namespace
+
+bool Profiler::isCompiledIn()
+{
+#ifdef MOTION_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::record(const char *name, int64_t begin, int64_t end)
+{
+    ThreadBuffer *buffer = threadBuffer ? threadBuffer : registerThread();
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    buffer->events[index % EVENTS_PER_THREAD] = {name, begin, end};
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char *name)
+{
+    ThreadBuffer *buffer = threadBuffer ? threadBuffer : registerThread();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer->name = name;
+}
+
+bool Profiler::writeChromeTrace(const std::string &path)
+{
+    if (!isCompiledIn())
+    {
+        LOG_WARNING("WARNING: Built without profiling (configure with -DENABLE_PROFILING=ON), no trace written");
+        return false;
+    }
+
+    // Copy every ring first so file I/O never holds up recording threads
+    struct ThreadEvents
+    {
+        int id;
+        std::string name;
+        std::vector<Event> events;
+    };
+    std::vector<ThreadEvents> threads;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto &buffer : reg.buffers)
+        {
+            threads.push_back({buffer->id, buffer->name, {}});
+            snapshot(*buffer, threads.back().events);
+        }
+    }
+
+    int64_t origin = INT64_MAX;
+    size_t eventCount = 0;
+    for (const ThreadEvents &thread : threads)
+    {
+        for (const Event &event : thread.events)
+            origin = std::min(origin, event.begin);
+        eventCount += thread.events.size();
+    }
+
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        LOG_ERROR("Cannot write trace: " << path);
+        return false;
+    }
+
+    // Complete ("X") events with microsecond timestamps, plus thread names
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    bool first = true;
+    for (const ThreadEvents &thread : threads)
+    {
+        std::fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                     first ? "" : ",", thread.id);
+        writeQuoted(file, thread.name.c_str());
+        std::fputs("}}", file);
+        first = false;
+
+        for (const Event &event : thread.events)
+        {
+            std::fputs(",\n{\"name\":", file);
+            writeQuoted(file, event.name);
+            std::fprintf(file, ",\"cat\":\"motion\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         thread.id, (event.begin - origin) / 1000.0, (event.end - event.begin) / 1000.0);
+        }
+    }
+    std::fputs("\n]}\n", file);
+
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        LOG_ERROR("Cannot write trace: " << path);
+        return false;
+    }
+    LOG_INFO("Trace written to " << path << ": " << eventCount << " events from " << threads.size()
+             << " threads");
+    return true;
+}
@@ -1,12 +1,22 @@
 #include "motion/Renderer.h"
+#include "motion/Logger.h"
 #include "motion/Mesh.h"
-#include <iostream>
+#include "motion/Profiler.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
 Renderer::Renderer() 
     : shaderProgram(0)
+    , uniforms{-1, -1, -1, -1, -1}
+    , instancedProgram(0)
+    , instancedUniforms{-1, -1, -1, -1, -1}
+    , mappedInstances(nullptr)
+    , frameData()
+    , frameCameraPosition(0.0f)
     , cameraDistance(8.0f)
     , cameraYaw(45.0f)
     , cameraPitch(35.0f)
@@ -17,6 +27,11 @@ Renderer::Renderer()
     , lastY(300.0f)
     , windowWidth(800)
     , windowHeight(600)
+    , fieldOfView(45.0f)
+    , lodPixelError(1.0f)
+    , lastLod(0)
+    , parallelShaderCompile(false)
+    , frameCounter(0)
 {
 }
 
@@ -30,8 +45,8 @@ std::string Renderer::loadShaderFromFile(const std::string& filepath)
     std::ifstream file(filepath);
     if (!file.is_open())
     {
-        std::cerr << "ERROR: Failed to open shader file: " << filepath << std::endl;
-        std::cerr << "Please ensure the file exists and is readable." << std::endl;
+        LOG_ERROR("ERROR: Failed to open shader file: " << filepath);
+        LOG_ERROR("Please ensure the file exists and is readable.");
         return "";
     }
     
@@ -42,11 +57,11 @@ std::string Renderer::loadShaderFromFile(const std::string& filepath)
     std::string content = buffer.str();
     if (content.empty())
     {
-        std::cerr << "WARNING: Shader file is empty: " << filepath << std::endl;
+        LOG_WARNING("WARNING: Shader file is empty: " << filepath);
         return "";
     }
     
-    std::cout << "Successfully loaded shader file: " << filepath << " (" << content.length() << " characters)" << std::endl;
+    LOG_DEBUG("Successfully loaded shader file: " << filepath << " (" << content.length() << " characters)");
     return content;
 }
 
@@ -54,15 +69,20 @@ unsigned int Renderer::compileShader(const std::string& source, GLenum type)
 {
     if (source.empty())
     {
-        std::cerr << "ERROR: Cannot compile empty shader source" << std::endl;
+        LOG_ERROR("ERROR: Cannot compile empty shader source");
         return 0;
     }
 
+    // The result is checked in checkShader once the build is done
     const char* src = source.c_str();
     unsigned int shader = glCreateShader(type);
     glShaderSource(shader, 1, &src, NULL);
     glCompileShader(shader);
+    return shader;
+}
 
+bool Renderer::checkShader(unsigned int shader, GLenum type)
+{
     int success;
     char infoLog[512];
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
@@ -70,37 +90,82 @@ unsigned int Renderer::compileShader(const std::string& source, GLenum type)
     {
         glGetShaderInfoLog(shader, 512, NULL, infoLog);
         const char* shaderType = (type == GL_VERTEX_SHADER) ? "VERTEX" : "FRAGMENT";
-        std::cerr << "ERROR::SHADER::" << shaderType << "::COMPILATION_FAILED" << std::endl;
-        std::cerr << infoLog << std::endl;
-        glDeleteShader(shader);
-        return 0;
+        LOG_ERROR("ERROR::SHADER::" << shaderType << "::COMPILATION_FAILED");
+        LOG_ERROR(infoLog);
+        return false;
     }
 
-    std::cout << "Successfully compiled " << ((type == GL_VERTEX_SHADER) ? "vertex" : "fragment") << " shader" << std::endl;
-    return shader;
+    LOG_DEBUG("Successfully compiled " << ((type == GL_VERTEX_SHADER) ? "vertex" : "fragment") << " shader");
+    return true;
 }
 
-unsigned int Renderer::loadShadersFromFiles(const std::string& vertexPath, const std::string& fragmentPath)
+// Insert preprocessor definitions after the #version directive
+static std::string injectDefines(const std::string& source, const std::string& defines)
 {
-    std::cout << "Loading shaders from files..." << std::endl;
-    std::cout << "  Vertex shader: " << vertexPath << std::endl;
-    std::cout << "  Fragment shader: " << fragmentPath << std::endl;
+    if (defines.empty())
+        return source;
+
+    size_t versionLine = source.find("#version");
+    size_t insertAt = versionLine == std::string::npos ? 0 : source.find('\n', versionLine);
+    if (insertAt == std::string::npos)
+        return source + "\n" + defines;
+    if (versionLine != std::string::npos)
+        insertAt++;
+    return source.substr(0, insertAt) + defines + source.substr(insertAt);
+}
+
+unsigned int Renderer::loadShadersFromFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                                            const std::string& defines)
+{
+    PendingProgram pending;
+    if (!startProgramBuild(vertexPath, fragmentPath, defines, pending))
+        return 0;
+    return finishProgramBuild(pending);
+}
+
+bool Renderer::startProgramBuild(const std::string& vertexPath, const std::string& fragmentPath,
+                                 const std::string& defines, PendingProgram& pending)
+{
+    PROFILE_SCOPE("shader compile");
+    LOG_INFO("Loading shaders from files...");
+    LOG_INFO("  Vertex shader: " << vertexPath);
+    LOG_INFO("  Fragment shader: " << fragmentPath);
 
     // Load shader source code from files
     std::string vertexSource = loadShaderFromFile(vertexPath);
     std::string fragmentSource = loadShaderFromFile(fragmentPath);
+    if (!vertexSource.empty())
+        vertexSource = injectDefines(vertexSource, defines);
+    if (!fragmentSource.empty())
+        fragmentSource = injectDefines(fragmentSource, defines);
     
     // Check if both files were loaded successfully
     if (vertexSource.empty())
     {
-        std::cerr << "ERROR: Failed to load vertex shader from: " << vertexPath << std::endl;
-        return 0;
+        LOG_ERROR("ERROR: Failed to load vertex shader from: " << vertexPath);
+        return false;
     }
     
     if (fragmentSource.empty())
     {
-        std::cerr << "ERROR: Failed to load fragment shader from: " << fragmentPath << std::endl;
-        return 0;
+        LOG_ERROR("ERROR: Failed to load fragment shader from: " << fragmentPath);
+        return false;
+    }
+
+    pending = PendingProgram();
+    pending.startFrame = frameCounter;
+    pending.start = std::chrono::high_resolution_clock::now();
+
+    // Reuse the driver's linked binary from an earlier run when it accepts it
+    if (shaderCache.isEnabled())
+    {
+        pending.cacheKey = shaderCache.buildKey(vertexSource, fragmentSource, defines);
+        if (unsigned int cached = shaderCache.load(pending.cacheKey))
+        {
+            pending.program = cached;
+            pending.fromCache = true;
+            return true;
+        }
     }
     
     // Compile shaders
@@ -109,103 +174,285 @@ unsigned int Renderer::loadShadersFromFiles(const std::string& vertexPath, const
     
     if (vertexShader == 0 || fragmentShader == 0)
     {
-        std::cerr << "ERROR: Shader compilation failed" << std::endl;
+        LOG_ERROR("ERROR: Shader compilation failed");
         if (vertexShader != 0) glDeleteShader(vertexShader);
         if (fragmentShader != 0) glDeleteShader(fragmentShader);
-        return 0;
+        return false;
     }
     
-    // Create program
+    // Create program; with parallel compilation this returns before the driver is done
     unsigned int program = glCreateProgram();
     glAttachShader(program, vertexShader);
     glAttachShader(program, fragmentShader);
+    if (pending.cacheKey != 0)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
-    
-    // Check linking
-    int success;
-    char infoLog[512];
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    pending.program = program;
+    pending.vertexShader = vertexShader;
+    pending.fragmentShader = fragmentShader;
+    return true;
+}
+
+bool Renderer::isProgramBuildDone(const PendingProgram& pending) const
+{
+    if (pending.program == 0 || pending.fromCache)
+        return true;
+
+    // Without parallel compilation the status query in finishProgramBuild blocks,
+    // so give the driver at least one whole frame before asking
+    if (!parallelShaderCompile)
+        return frameCounter > pending.startFrame;
+
+    GLint done = GL_FALSE;
+    glGetProgramiv(pending.program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+unsigned int Renderer::finishProgramBuild(PendingProgram& pending)
+{
+    PROFILE_SCOPE("shader link");
+    unsigned int program = pending.program;
+    double elapsedMs = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::high_resolution_clock::now() - pending.start).count() / 1000.0;
+    if (pending.fromCache)
+    {
+        LOG_INFO("Loaded shader program from binary cache in " << elapsedMs << "ms");
+        pending = PendingProgram();
+        return program;
+    }
+
+    // Check both stages so every compile error is reported, then linking
+    bool vertexCompiled = checkShader(pending.vertexShader, GL_VERTEX_SHADER);
+    bool fragmentCompiled = checkShader(pending.fragmentShader, GL_FRAGMENT_SHADER);
+    int success = 0;
+    if (vertexCompiled && fragmentCompiled)
+    {
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            char infoLog[512];
+            glGetProgramInfoLog(program, 512, NULL, infoLog);
+            LOG_ERROR("ERROR::SHADER::PROGRAM::LINKING_FAILED");
+            LOG_ERROR(infoLog);
+        }
+    }
+    else
+    {
+        LOG_ERROR("ERROR: Shader compilation failed");
+    }
+
+    // Clean up individual shaders (they're now part of the program)
+    glDeleteShader(pending.vertexShader);
+    glDeleteShader(pending.fragmentShader);
+    uint64_t cacheKey = pending.cacheKey;
+    pending = PendingProgram();
+
     if (!success)
     {
-        glGetProgramInfoLog(program, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED" << std::endl;
-        std::cerr << infoLog << std::endl;
-        
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
         glDeleteProgram(program);
         return 0;
     }
+
+    if (cacheKey != 0)
+        shaderCache.store(cacheKey, program);
     
-    // Clean up individual shaders (they're now part of the program)
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    std::cout << "Successfully created shader program" << std::endl;
+    LOG_INFO("Successfully created shader program in " << elapsedMs << "ms");
     return program;
 }
 
+void Renderer::cancelProgramBuild(PendingProgram& pending)
+{
+    if (pending.vertexShader != 0)
+        glDeleteShader(pending.vertexShader);
+    if (pending.fragmentShader != 0)
+        glDeleteShader(pending.fragmentShader);
+    if (pending.program != 0)
+        glDeleteProgram(pending.program);
+    pending = PendingProgram();
+}
+
+void Renderer::enableParallelShaderCompile()
+{
+    // Let the driver compile on its own threads; 0xFFFFFFFF means implementation maximum
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallelShaderCompile = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallelShaderCompile = true;
+    }
+}
+
+void Renderer::reloadShaders()
+{
+    if (shaderProgram == 0)
+        return;
+
+    LOG_INFO("Shader files changed, recompiling in the background");
+    cancelProgramBuild(pendingProgram);
+    startProgramBuild(vertexShaderPath, fragmentShaderPath, shaderDefines, pendingProgram);
+
+    if (instancedProgram != 0)
+    {
+        cancelProgramBuild(pendingInstancedProgram);
+        startProgramBuild(instancedVertexShaderPath, instancedFragmentShaderPath, shaderDefines, pendingInstancedProgram);
+    }
+}
+
+void Renderer::swapReloadedProgram(PendingProgram& pending, unsigned int& program, UniformLocations& locations)
+{
+    if (pending.program == 0 || !isProgramBuildDone(pending))
+        return;
+
+    unsigned int rebuilt = finishProgramBuild(pending);
+    UniformLocations rebuiltLocations = locations;
+    if (rebuilt == 0 || !setupProgramBindings(rebuilt, rebuiltLocations))
+    {
+        if (rebuilt != 0)
+            glDeleteProgram(rebuilt);
+        LOG_ERROR("Shader reload failed, keeping the previous program");
+        return;
+    }
+
+    GLStateCache::get().programDeleted(program);
+    glDeleteProgram(program);
+    program = rebuilt;
+    locations = rebuiltLocations;
+    LOG_INFO("Shader program reloaded");
+}
+
 void Renderer::setupShaders()
 {
     // Always try to load from files - no fallbacks
-    shaderProgram = loadShadersFromFiles("shaders/vertex.glsl", "shaders/fragment.glsl");
+    vertexShaderPath = "shaders/vertex.glsl";
+    fragmentShaderPath = "shaders/fragment.glsl";
+    shaderProgram = loadShadersFromFiles(vertexShaderPath, fragmentShaderPath);
     
     if (shaderProgram == 0)
     {
-        std::cerr << "CRITICAL ERROR: Failed to load shaders!" << std::endl;
-        std::cerr << "Please ensure the following files exist:" << std::endl;
-        std::cerr << "  - shaders/vertex.glsl" << std::endl;
-        std::cerr << "  - shaders/fragment.glsl" << std::endl;
+        LOG_ERROR("CRITICAL ERROR: Failed to load shaders!");
+        LOG_ERROR("Please ensure the following files exist:");
+        LOG_ERROR("  - shaders/vertex.glsl");
+        LOG_ERROR("  - shaders/fragment.glsl");
     }
 }
 
 bool Renderer::initialize()
 {
-    std::cout << "Initializing renderer..." << std::endl;
+    LOG_INFO("Initializing renderer...");
     
     // Configure OpenGL
-    glEnable(GL_DEPTH_TEST);
+    GLStateCache::get().setEnabled(GL_DEPTH_TEST, true);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     
     // Setup shaders from files
+    enableParallelShaderCompile();
     setupShaders();
     
-    if (shaderProgram == 0)
+    if (shaderProgram == 0 || !setupProgramBindings(shaderProgram, uniforms))
     {
-        std::cerr << "ERROR: Renderer initialization failed - could not load shaders" << std::endl;
+        LOG_ERROR("ERROR: Renderer initialization failed - could not load shaders");
         return false;
     }
     
-    std::cout << "Renderer initialized successfully" << std::endl;
+    LOG_INFO("Renderer initialized successfully");
     return true;
 }
 
-bool Renderer::initializeWithShaderFiles(const std::string& vertexPath, const std::string& fragmentPath)
+bool Renderer::initializeWithShaderFiles(const std::string& vertexPath, const std::string& fragmentPath,
+                                         const std::string& defines)
 {
-    std::cout << "Initializing renderer with custom shaders..." << std::endl;
+    LOG_INFO("Initializing renderer with custom shaders...");
     
     // Configure OpenGL
-    glEnable(GL_DEPTH_TEST);
+    GLStateCache::get().setEnabled(GL_DEPTH_TEST, true);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     
     // Load custom shaders
-    shaderProgram = loadShadersFromFiles(vertexPath, fragmentPath);
+    enableParallelShaderCompile();
+    vertexShaderPath = vertexPath;
+    fragmentShaderPath = fragmentPath;
+    shaderDefines = defines;
+    shaderProgram = loadShadersFromFiles(vertexPath, fragmentPath, defines);
     
-    if (shaderProgram == 0)
+    if (shaderProgram == 0 || !setupProgramBindings(shaderProgram, uniforms))
     {
-        std::cerr << "ERROR: Renderer initialization failed - could not load custom shaders" << std::endl;
+        LOG_ERROR("ERROR: Renderer initialization failed - could not load custom shaders");
         return false;
     }
     
-    std::cout << "Renderer initialized successfully with custom shaders" << std::endl;
+    LOG_INFO("Renderer initialized successfully with custom shaders");
+    return true;
+}
+
+bool Renderer::setupProgramBindings(unsigned int program, UniformLocations &locations)
+{
+    unsigned int blockIndex = glGetUniformBlockIndex(program, "FrameData");
+    if (blockIndex == GL_INVALID_INDEX)
+    {
+        LOG_ERROR("ERROR: Shader program has no FrameData uniform block");
+        return false;
+    }
+    glUniformBlockBinding(program, blockIndex, FRAME_DATA_BINDING);
+
+    locations.model = glGetUniformLocation(program, "model");
+    locations.normalMatrix = glGetUniformLocation(program, "normalMatrix");
+    locations.positionScale = glGetUniformLocation(program, "positionScale");
+    locations.positionOffset = glGetUniformLocation(program, "positionOffset");
+    locations.objectColor = glGetUniformLocation(program, "objectColor");
+
+    if (frameDataRing.getBuffer() == 0)
+    {
+        GLint uniformAlignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+        frameDataRing.create(sizeof(FrameData), static_cast<size_t>(uniformAlignment));
+    }
+    return true;
+}
+
+bool Renderer::loadInstancedShaders(const std::string& vertexPath, const std::string& fragmentPath)
+{
+    unsigned int program = loadShadersFromFiles(vertexPath, fragmentPath, shaderDefines);
+    if (program == 0 || !setupProgramBindings(program, instancedUniforms))
+    {
+        LOG_WARNING("WARNING: Instanced shaders unavailable, instances will be drawn one at a time");
+        if (program != 0)
+        {
+            GLStateCache::get().programDeleted(program);
+            glDeleteProgram(program);
+        }
+        return false;
+    }
+
+    instancedProgram = program;
+    instancedVertexShaderPath = vertexPath;
+    instancedFragmentShaderPath = fragmentPath;
+    instanceRing.create(1024 * sizeof(InstanceData)); // Grows on demand
     return true;
 }
 
 void Renderer::cleanup()
 {
+    cancelProgramBuild(pendingProgram);
+    cancelProgramBuild(pendingInstancedProgram);
+
+    if (instancedProgram != 0)
+    {
+        GLStateCache::get().programDeleted(instancedProgram);
+        glDeleteProgram(instancedProgram);
+        instancedProgram = 0;
+    }
+    instanceRing.destroy();
+    frameDataRing.destroy();
+
     if (shaderProgram != 0)
     {
-        std::cout << "Cleaning up shader program" << std::endl;
+        LOG_INFO("Cleaning up shader program");
+        GLStateCache::get().programDeleted(shaderProgram);
         glDeleteProgram(shaderProgram);
         shaderProgram = 0;
     }
@@ -225,7 +472,14 @@ void Renderer::resetCamera()
     cameraYaw = 45.0f;
     cameraPitch = 35.0f;
     cameraTarget = glm::vec3(0.0f, 0.0f, 0.0f);
-    std::cout << "Camera reset to default position" << std::endl;
+    LOG_INFO("Camera reset to default position");
+}
+
+void Renderer::setCameraOrbit(float yaw, float pitch, float distance)
+{
+    cameraYaw = yaw;
+    cameraPitch = pitch;
+    cameraDistance = distance;
 }
 
 void Renderer::onFramebufferSize(int width, int height)
@@ -233,7 +487,7 @@ void Renderer::onFramebufferSize(int width, int height)
     windowWidth = width;
     windowHeight = height;
     glViewport(0, 0, width, height);
-    std::cout << "Framebuffer resized to: " << width << "x" << height << std::endl;
+    LOG_INFO("Framebuffer resized to: " << width << "x" << height);
 }
 
 void Renderer::onMouseMove(double xpos, double ypos)
@@ -295,42 +549,225 @@ void Renderer::clear()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void Renderer::renderMesh(Mesh* mesh, const glm::mat4& model)
+void Renderer::beginFrame()
+{
+    // Programs rebuilt in the background are swapped in between frames
+    swapReloadedProgram(pendingProgram, shaderProgram, uniforms);
+    swapReloadedProgram(pendingInstancedProgram, instancedProgram, instancedUniforms);
+    frameCounter++;
+
+    // Camera and light are shared by every draw in the frame
+    frameCameraPosition = getCameraPosition();
+    float aspectRatio = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
+
+    frameData.view = glm::lookAt(frameCameraPosition, cameraTarget, glm::vec3(0, 1, 0));
+    frameData.projection = glm::perspective(glm::radians(fieldOfView), aspectRatio, 0.1f, 100.0f);
+    // Light position relative to camera for better visibility
+    frameData.lightPosition = glm::vec4(frameCameraPosition + glm::vec3(2.0f, 2.0f, 2.0f), 1.0f);
+    frameData.lightColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    frameData.viewPosition = glm::vec4(frameCameraPosition, 1.0f);
+
+    if (void *block = frameDataRing.map(sizeof(FrameData)))
+    {
+        std::memcpy(block, &frameData, sizeof(FrameData));
+        frameDataRing.unmap();
+        GLStateCache::get().bindUniformBufferRange(FRAME_DATA_BINDING, frameDataRing.getBuffer(),
+                                                   frameDataRing.getOffset(), sizeof(FrameData));
+    }
+}
+
+void Renderer::endFrame()
+{
+    flush();
+    frameDataRing.endFrame();
+    instanceRing.endFrame();
+    GLStateCache::get().endFrame();
+}
+
+glm::mat3 computeNormalMatrix(const glm::mat4& model, bool rigidTransform)
+{
+    glm::mat3 linear(model);
+    return rigidTransform ? linear : glm::transpose(glm::inverse(linear));
+}
+
+void Renderer::renderMesh(Mesh* mesh, const glm::mat4& model, bool rigidTransform)
+{
+    PROFILE_SCOPE("renderMesh");
+    submit(mesh, model, rigidTransform);
+}
+
+void Renderer::submit(Mesh* mesh, const glm::mat4& model, bool rigidTransform, const glm::vec3& color)
+{
+    queueDraw(mesh, model, computeNormalMatrix(model, rigidTransform), color);
+}
+
+void Renderer::queueDraw(Mesh* mesh, const glm::mat4& model, const glm::mat3& normalMatrix, const glm::vec3& color)
 {
     if (!mesh)
     {
-        std::cerr << "WARNING: Attempting to render null mesh" << std::endl;
+        LOG_WARNING("WARNING: Attempting to render null mesh");
         return;
     }
-    
+
+    auto channel = [](float c) { return static_cast<uint64_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f); };
+    uint64_t material = channel(color.x) << 16 | channel(color.y) << 8 | channel(color.z);
+
+    DrawItem item;
+    item.key = static_cast<uint64_t>(shaderProgram & 0xFFFF) << 48 |
+               static_cast<uint64_t>(mesh->getVertexArray() & 0xFFFFFF) << 24 | material;
+    item.mesh = mesh;
+    item.model = model;
+    item.color = color;
+    item.normalMatrix = normalMatrix;
+    drawQueue.push_back(item);
+}
+
+void Renderer::flush()
+{
+    PROFILE_SCOPE("Renderer::flush");
+    if (drawQueue.empty())
+        return;
+
     if (shaderProgram == 0)
     {
-        std::cerr << "ERROR: Cannot render - no valid shader program" << std::endl;
+        LOG_ERROR("ERROR: Cannot render - no valid shader program");
+        drawQueue.clear();
         return;
     }
-    
-    glUseProgram(shaderProgram);
 
-    // Calculate camera position
-    glm::vec3 cameraPos = getCameraPosition();
+    std::stable_sort(drawQueue.begin(), drawQueue.end(),
+                     [](const DrawItem &a, const DrawItem &b) { return a.key < b.key; });
 
-    // Set up view and projection matrices with current window aspect ratio
-    glm::mat4 view = glm::lookAt(cameraPos, cameraTarget, glm::vec3(0, 1, 0));
-    float aspectRatio = static_cast<float>(windowWidth) / static_cast<float>(windowHeight);
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
-
-    // Set uniforms
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-    // Lighting uniforms (light position relative to camera for better visibility)
-    glm::vec3 lightPos = cameraPos + glm::vec3(2.0f, 2.0f, 2.0f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
-    glUniform3f(glGetUniformLocation(shaderProgram, "lightColor"), 1.0f, 1.0f, 1.0f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), 0.8f, 0.4f, 0.2f);
-    glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), cameraPos.x, cameraPos.y, cameraPos.z);
-
-    // Render mesh
-    mesh->render();
+    GLStateCache &state = GLStateCache::get();
+    state.useProgram(shaderProgram);
+
+    // Uniforms only change at key boundaries; the model matrices change every draw
+    const Mesh *boundMesh = nullptr;
+    uint64_t boundMaterial = ~0ull;
+    for (const DrawItem &item : drawQueue)
+    {
+        uint64_t material = item.key & 0xFFFFFF;
+        if (material != boundMaterial)
+        {
+            glUniform3f(uniforms.objectColor, item.color.x, item.color.y, item.color.z);
+            boundMaterial = material;
+        }
+
+        // Vertex dequantization for compact meshes
+        if (item.mesh != boundMesh)
+        {
+            glm::vec3 positionScale = item.mesh->getPositionScale();
+            glm::vec3 positionOffset = item.mesh->getPositionOffset();
+            glUniform3f(uniforms.positionScale, positionScale.x, positionScale.y, positionScale.z);
+            glUniform3f(uniforms.positionOffset, positionOffset.x, positionOffset.y, positionOffset.z);
+            boundMesh = item.mesh;
+        }
+
+        // Per-object uniforms; camera and light come from the FrameData block
+        glUniformMatrix4fv(uniforms.model, 1, GL_FALSE, glm::value_ptr(item.model));
+        glUniformMatrix3fv(uniforms.normalMatrix, 1, GL_FALSE, glm::value_ptr(item.normalMatrix));
+
+        // Render mesh at the level the current view can resolve
+        lastLod = selectLod(item.mesh, item.model, frameCameraPosition);
+        if (lastLod == 0 && item.mesh->getMeshletCount() > 0)
+        {
+            glm::vec3 objectCamera = glm::vec3(glm::inverse(item.model) * glm::vec4(frameCameraPosition, 1.0f));
+            item.mesh->renderCulled(frameData.projection * frameData.view * item.model, objectCamera, cullStats);
+        }
+        else
+        {
+            cullStats = MeshletCullStats();
+            item.mesh->render(lastLod);
+        }
+    }
+    drawQueue.clear();
+}
+
+void Renderer::renderInstanced(Mesh* mesh, const glm::mat4* models, size_t count, bool rigidTransforms)
+{
+    PROFILE_SCOPE("renderInstanced");
+    if (!mesh || count == 0)
+        return;
+
+    if (instancedProgram == 0)
+    {
+        for (size_t i = 0; i < count; i++)
+            renderMesh(mesh, models[i], rigidTransforms);
+        return;
+    }
+
+    // Normal matrices are computed here once per instance instead of per vertex
+    InstanceData *instances = mapInstances(count);
+    if (!instances)
+        return;
+    for (size_t i = 0; i < count; i++)
+    {
+        instances[i].model = models[i];
+        instances[i].normalMatrix = computeNormalMatrix(models[i], rigidTransforms);
+    }
+    drawInstances(mesh, count);
+}
+
+InstanceData *Renderer::mapInstances(size_t count)
+{
+    if (instancedProgram == 0)
+    {
+        // No instanced program: stage in CPU memory for per-object draws
+        fallbackInstances.resize(count);
+        mappedInstances = fallbackInstances.data();
+        return mappedInstances;
+    }
+
+    mappedInstances = static_cast<InstanceData *>(instanceRing.map(count * sizeof(InstanceData)));
+    return mappedInstances;
+}
+
+void Renderer::drawInstances(Mesh* mesh, size_t count)
+{
+    if (!mesh || !mappedInstances || count == 0)
+        return;
+
+    if (instancedProgram == 0)
+    {
+        // Keep the normal matrices the caller computed, as the instanced path does
+        for (size_t i = 0; i < count; i++)
+            queueDraw(mesh, mappedInstances[i].model, mappedInstances[i].normalMatrix, glm::vec3(0.8f, 0.4f, 0.2f));
+        mappedInstances = nullptr;
+        return;
+    }
+
+    instanceRing.unmap();
+    mappedInstances = nullptr;
+
+    GLStateCache::get().useProgram(instancedProgram);
+    glUniform3f(instancedUniforms.objectColor, 0.8f, 0.4f, 0.2f);
+    glm::vec3 positionScale = mesh->getPositionScale();
+    glm::vec3 positionOffset = mesh->getPositionOffset();
+    glUniform3f(instancedUniforms.positionScale, positionScale.x, positionScale.y, positionScale.z);
+    glUniform3f(instancedUniforms.positionOffset, positionOffset.x, positionOffset.y, positionOffset.z);
+
+    mesh->bindInstanceBuffer(instanceRing.getBuffer(), instanceRing.getOffset());
+    mesh->renderInstanced(count);
+    lastLod = 0;
+    cullStats = MeshletCullStats();
+}
+
+size_t Renderer::selectLod(const Mesh *mesh, const glm::mat4 &model, const glm::vec3 &cameraPos) const
+{
+    size_t lodCount = mesh->getLodCount();
+    if (lodCount < 2)
+        return 0;
+
+    // Pixels covered by one world unit at the mesh's distance from the eye
+    glm::vec3 center = glm::vec3(model * glm::vec4(mesh->getBoundsCenter(), 1.0f));
+    float distance = std::max(glm::length(center - cameraPos) - mesh->getBoundingRadius(), 0.1f);
+    float pixelsPerUnit = windowHeight * 0.5f / (distance * std::tan(glm::radians(fieldOfView) * 0.5f));
+
+    // Levels are ordered fine to coarse with growing error
+    for (size_t lod = lodCount - 1; lod > 0; lod--)
+    {
+        if (mesh->getLod(lod).error * pixelsPerUnit <= lodPixelError)
+            return lod;
+    }
+    return 0;
 }
\ No newline at end of file
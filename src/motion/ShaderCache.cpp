@@ -0,0 +1,170 @@
+#include "motion/ShaderCache.h"
+#include "motion/Logger.h"
+#include "motion/MeshCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+struct ShaderCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+};
+
+static const char SHADER_CACHE_MAGIC[4] = {'K', 'F', 'P', 'G'};
+
+ShaderCache::ShaderCache(const std::string &cacheDirectory)
+    : directory(cacheDirectory), supported(-1)
+{
+}
+
+bool ShaderCache::isEnabled()
+{
+    if (directory.empty())
+        return false;
+
+    if (supported < 0)
+    {
+        GLint formats = 0;
+        if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0;
+        if (!supported)
+            LOG_INFO("Program binaries not supported by the driver, shader cache disabled");
+    }
+    return supported != 0;
+}
+
+std::string ShaderCache::getCachePath(uint64_t key) const
+{
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".kfprog";
+    return (std::filesystem::path(directory) / "shaders" / name.str()).string();
+}
+
+uint64_t ShaderCache::buildKey(const std::string &vertexSource, const std::string &fragmentSource,
+                               const std::string &defines) const
+{
+    // A driver update changes at least one of these strings and invalidates all binaries
+    const GLenum driverStrings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    uint32_t version = VERSION;
+    uint64_t hash = hashBytes(&version, sizeof(version));
+    for (GLenum name : driverStrings)
+    {
+        const char *value = reinterpret_cast<const char *>(glGetString(name));
+        if (value)
+            hash = hashBytes(value, std::strlen(value) + 1, hash);
+    }
+
+    // Lengths are hashed too so text moving between the parts changes the key
+    for (const std::string *part : {&vertexSource, &fragmentSource, &defines})
+    {
+        uint64_t length = part->size();
+        hash = hashBytes(&length, sizeof(length), hash);
+        hash = hashBytes(part->data(), part->size(), hash);
+    }
+    return hash;
+}
+
+unsigned int ShaderCache::load(uint64_t key)
+{
+    if (!isEnabled())
+        return 0;
+
+    std::string path = getCachePath(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return 0;
+
+    ShaderCacheHeader header;
+    std::vector<char> binary;
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    bool valid = in && std::memcmp(header.magic, SHADER_CACHE_MAGIC, 4) == 0 && header.version == VERSION &&
+                 header.key == key && header.binarySize > 0;
+    if (valid)
+    {
+        binary.resize(header.binarySize);
+        in.read(binary.data(), binary.size());
+        valid = static_cast<bool>(in);
+    }
+    in.close();
+
+    unsigned int program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program == 0)
+    {
+        LOG_INFO("Shader cache entry rejected, recompiling: " << path);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return program;
+}
+
+bool ShaderCache::store(uint64_t key, unsigned int program)
+{
+    if (!isEnabled())
+        return false;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0)
+        return false;
+
+    ShaderCacheHeader header = {};
+    std::memcpy(header.magic, SHADER_CACHE_MAGIC, 4);
+    header.version = VERSION;
+    header.key = key;
+    header.binaryFormat = format;
+    header.binarySize = static_cast<uint32_t>(length);
+
+    std::string path = getCachePath(key);
+    std::string tempPath = path + ".tmp";
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(binary.data(), length);
+    out.close();
+    if (!out)
+    {
+        LOG_ERROR("Failed to write shader cache: " << tempPath);
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    // Atomic replace so a crash never leaves a half-written entry behind
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        LOG_ERROR("Failed to finalize shader cache: " << path);
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
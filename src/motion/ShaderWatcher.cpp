@@ -0,0 +1,142 @@
+#include "motion/ShaderWatcher.h"
+#include "motion/Logger.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Quiet time before a change is reported, and the timestamp polling interval
+static const std::chrono::milliseconds SETTLE_TIME(100);
+static const std::chrono::milliseconds SCAN_INTERVAL(500);
+
+ShaderWatcher::ShaderWatcher() : inotifyFd(-1), changePending(false) {}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    stop();
+}
+
+bool ShaderWatcher::watch(const std::vector<std::string> &paths)
+{
+    stop();
+
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+        LOG_WARNING("WARNING: inotify unavailable, polling shader timestamps instead");
+#endif
+
+    for (const std::string &path : paths)
+    {
+        std::filesystem::path file(path);
+        WatchedFile entry;
+        entry.directory = file.has_parent_path() ? file.parent_path().string() : ".";
+        entry.name = file.filename().string();
+        entry.watch = -1;
+
+        std::error_code ec;
+        entry.lastWrite = std::filesystem::last_write_time(file, ec);
+
+#ifdef __linux__
+        // Adding the same directory twice returns the existing descriptor
+        if (inotifyFd >= 0)
+        {
+            entry.watch = inotify_add_watch(inotifyFd, entry.directory.c_str(),
+                                            IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (entry.watch < 0)
+            {
+                LOG_WARNING("WARNING: Cannot watch shader directory: " << entry.directory);
+                continue;
+            }
+        }
+#endif
+        files.push_back(entry);
+    }
+
+    lastScan = Clock::now();
+    return !files.empty();
+}
+
+void ShaderWatcher::stop()
+{
+#ifdef __linux__
+    if (inotifyFd >= 0)
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+#endif
+    files.clear();
+    changePending = false;
+}
+
+bool ShaderWatcher::readEvents()
+{
+    bool changed = false;
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *cursor = buffer; cursor < buffer + length;)
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(cursor);
+            for (const WatchedFile &file : files)
+            {
+                if (event->len > 0 && file.watch == event->wd && file.name == event->name)
+                    changed = true;
+            }
+            cursor += sizeof(inotify_event) + event->len;
+        }
+    }
+#endif
+    return changed;
+}
+
+bool ShaderWatcher::scanTimestamps()
+{
+    bool changed = false;
+    for (WatchedFile &file : files)
+    {
+        std::error_code ec;
+        auto lastWrite = std::filesystem::last_write_time(std::filesystem::path(file.directory) / file.name, ec);
+        if (!ec && lastWrite != file.lastWrite)
+        {
+            file.lastWrite = lastWrite;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool ShaderWatcher::poll()
+{
+    if (files.empty())
+        return false;
+
+    Clock::time_point now = Clock::now();
+    bool changed = false;
+    if (inotifyFd >= 0)
+    {
+        changed = readEvents();
+    }
+    else if (now - lastScan >= SCAN_INTERVAL)
+    {
+        changed = scanTimestamps();
+        lastScan = now;
+    }
+
+    if (changed)
+    {
+        changePending = true;
+        lastChange = now;
+    }
+
+    if (changePending && now - lastChange >= SETTLE_TIME)
+    {
+        changePending = false;
+        return true;
+    }
+    return false;
+}
@@ -1,8 +1,23 @@
 #include "motion/Utils.h"
+#include "motion/Logger.h"
+#include "motion/MeshCache.h"
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <fstream>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
 bool parseKeyFramesFromString(const std::string &keyframeStr, OptimizedMotionController *controller)
 {
     if (keyframeStr.empty() || !controller)
@@ -89,29 +104,241 @@ void setupDefaultKeyFrames(OptimizedMotionController *controller)
     std::cout << "Using default keyframes" << std::endl;
 }
 
-bool loadMeshFromOBJ(const std::string &filename, Mesh **currentMesh)
+// Cache key for the processed form of filename under these options
+static bool buildCacheKey(const MeshCache &cache, const std::string &filename, const MeshLoadOptions &options,
+                          MeshCacheKey &key)
 {
-    if (!currentMesh)
+    if (!options.useCache || !cache.buildKey(filename, options.vertexFormat, key))
+        return false;
+
+    // Streamed entries have no indices, LODs or meshlets, so they never share
+    // a key with a parsed one; LOD and meshlet options do not apply to them
+    static const char STREAMED_TAG[] = "streamed";
+    if (options.streaming)
+    {
+        key.processingHash = hashBytes(STREAMED_TAG, sizeof(STREAMED_TAG) - 1);
+    }
+    else if (!options.lodRatios.empty() || options.buildMeshlets)
+    {
+        key.processingHash = hashBytes(options.lodRatios.data(), options.lodRatios.size() * sizeof(float));
+        key.processingHash = hashBytes(&options.buildMeshlets, sizeof(options.buildMeshlets), key.processingHash);
+    }
+    return true;
+}
+
+// Streamed entries never carry LODs or meshlets, warm or cold
+static void warnIfStreamingDropsProcessing(const MeshLoadOptions &options)
+{
+    if (options.streaming && (!options.lodRatios.empty() || options.buildMeshlets))
+        LOG_WARNING("WARNING: LODs and meshlets are not generated for streamed models");
+}
+
+// Stream an OBJ into a new cache entry without holding the expanded mesh
+static bool streamOBJToCache(const std::string &filename, const MeshLoadOptions &options,
+                             const MeshCache &cache, const MeshCacheKey &key)
+{
+    MeshCacheWriter writer;
+    if (!writer.open(cache, key))
         return false;
 
     OBJLoader loader;
+    OBJStreamStats stats;
+    bool streamed = loader.streamOBJ(filename, options.vertexFormat, options.memoryBudget,
+        [&writer](const unsigned char *data, size_t bytes, size_t)
+        {
+            return writer.writeVertices(data, bytes);
+        },
+        stats);
+
+    return streamed && writer.finish(stats.vertexCount, stats.boundsMin, stats.boundsMax, nullptr, 0);
+}
+
+// Stream an OBJ straight into the final CPU buffers
+static bool streamOBJToData(const std::string &filename, const MeshLoadOptions &options, MeshData &data)
+{
+    data = MeshData();
+    data.vertexFormat = options.vertexFormat;
+
+    OBJLoader loader;
+    OBJStreamStats stats;
+    bool streamed = loader.streamOBJ(filename, options.vertexFormat, options.memoryBudget,
+        [&data](const unsigned char *chunk, size_t bytes, size_t totalBytes)
+        {
+            if (data.vertexData.empty())
+                data.vertexData.reserve(totalBytes);
+            data.vertexData.insert(data.vertexData.end(), chunk, chunk + bytes);
+            return true;
+        },
+        stats);
+    if (!streamed)
+        return false;
+
+    data.vertexCount = stats.vertexCount;
+    data.boundsMin = stats.boundsMin;
+    data.boundsMax = stats.boundsMax;
+    return true;
+}
+
+bool loadMeshFromOBJ(const std::string &filename, Mesh **currentMesh, const MeshLoadOptions &options)
+{
+    if (!currentMesh)
+        return false;
+
+    auto loadStart = std::chrono::high_resolution_clock::now();
+
+    MeshCache cache(options.cacheDirectory);
+    MeshCacheKey key;
+    bool haveKey = buildCacheKey(cache, filename, options, key);
+    warnIfStreamingDropsProcessing(options);
+
     Mesh *newMesh = new Mesh();
+    newMesh->setVertexFormat(options.vertexFormat);
 
-    if (loader.loadOBJ(filename, *newMesh))
+    // Warm path: map the processed buffers and upload without parsing
+    bool cacheHit = haveKey && cache.load(key, *newMesh);
+    bool loaded = cacheHit;
+    if (!loaded && options.streaming)
     {
-        if (*currentMesh)
+        // Write the cache entry in chunks, then upload it from the mapping
+        if (haveKey)
         {
-            delete *currentMesh;
+            loaded = streamOBJToCache(filename, options, cache, key) && cache.load(key, *newMesh);
+        }
+        else
+        {
+            MeshData data;
+            loaded = streamOBJToData(filename, options, data);
+            if (loaded)
+                newMesh->uploadMeshData(data);
         }
-        *currentMesh = newMesh;
-        (*currentMesh)->setupBuffers();
-        return true;
     }
-    else
+    else if (!loaded)
+    {
+        OBJLoader loader;
+        if (loader.loadOBJ(filename, *newMesh))
+        {
+            newMesh->generateLods(options.lodRatios);
+            if (options.buildMeshlets)
+                newMesh->generateMeshlets();
+            MeshData data;
+            newMesh->buildMeshData(data);
+            newMesh->uploadMeshData(data);
+            if (haveKey)
+            {
+                cache.store(key, data);
+            }
+            loaded = true;
+        }
+    }
+
+    if (!loaded)
     {
         delete newMesh;
         return false;
     }
+
+    if (*currentMesh)
+    {
+        delete *currentMesh;
+    }
+    *currentMesh = newMesh;
+
+    auto loadEnd = std::chrono::high_resolution_clock::now();
+    auto loadDuration = std::chrono::duration_cast<std::chrono::microseconds>(loadEnd - loadStart);
+    LOG_INFO("Mesh ready in " << (loadDuration.count() / 1000.0f) << "ms ("
+             << (cacheHit ? "warm: cache hit" : (options.streaming ? "cold: streamed OBJ" : "cold: parsed OBJ"))
+             << "), peak RSS " << (getPeakRSSBytes() >> 20) << " MB");
+    return true;
+}
+
+bool loadMeshData(const std::string &filename, const MeshLoadOptions &options, MeshData &data,
+                  MappedMeshData *mapped)
+{
+    MeshCache cache(options.cacheDirectory);
+    MeshCacheKey key;
+    bool haveKey = buildCacheKey(cache, filename, options, key);
+    warnIfStreamingDropsProcessing(options);
+
+    auto readEntry = [&]()
+    {
+        return mapped ? cache.map(key, *mapped) : cache.loadData(key, data);
+    };
+
+    if (haveKey && readEntry())
+        return true;
+
+    if (options.streaming)
+    {
+        // Without the cache there is no file to map, so the vertices end up in data
+        bool loaded = haveKey ? streamOBJToCache(filename, options, cache, key) && readEntry()
+                              : streamOBJToData(filename, options, data);
+        LOG_INFO("Streamed model, peak RSS " << (getPeakRSSBytes() >> 20) << " MB");
+        return loaded;
+    }
+
+    // The mesh never gets GL buffers here, so it is safe to build off-thread
+    OBJLoader loader;
+    Mesh mesh;
+    mesh.setVertexFormat(options.vertexFormat);
+    if (!loader.loadOBJ(filename, mesh))
+        return false;
+
+    mesh.generateLods(options.lodRatios);
+    if (options.buildMeshlets)
+        mesh.generateMeshlets();
+    mesh.buildMeshData(data);
+    if (haveKey)
+    {
+        cache.store(key, data);
+    }
+    LOG_INFO("Parsed model, peak RSS " << (getPeakRSSBytes() >> 20) << " MB");
+    return true;
+}
+
+size_t getPeakRSSBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<size_t>(counters.PeakWorkingSetSize);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+// Whole decimal number in [minimum, maximum]; false for anything else,
+// including trailing text and values that do not fit
+static bool parseCount(const char *text, long long minimum, long long maximum, long long &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < minimum || parsed > maximum)
+        return false;
+    value = parsed;
+    return true;
+}
+
+// Whole finite decimal number in [minimum, maximum]; false for anything else,
+// including trailing text, NaN and values that overflow
+static bool parseNumber(const char *text, double minimum, double maximum, double &value)
+{
+    char *end = nullptr;
+    errno = 0;
+    double parsed = std::strtod(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !std::isfinite(parsed) || parsed < minimum ||
+        parsed > maximum)
+        return false;
+    value = parsed;
+    return true;
 }
 
 bool parseCommandLine(int argc, char *argv[], ProgramConfig &config)
@@ -167,6 +394,324 @@ bool parseCommandLine(int argc, char *argv[], ProgramConfig &config)
             config.objFilename = argv[i + 1];
             i++; // Skip next argument
         }
+        else if (arg == "-vf" && i + 1 < argc)
+        {
+            std::string vertexFormat = argv[i + 1];
+            if (vertexFormat == "float" || vertexFormat == "0")
+            {
+                config.vertexFormat = VertexFormat::Float32;
+            }
+            else if (vertexFormat == "compact" || vertexFormat == "1")
+            {
+                config.vertexFormat = VertexFormat::Compact;
+            }
+            else
+            {
+                std::cerr << "Invalid vertex format: " << vertexFormat << std::endl;
+                return false;
+            }
+            i++; // Skip next argument
+        }
+        else if (arg == "-cache" && i + 1 < argc)
+        {
+            config.meshCacheDirectory = argv[i + 1];
+            config.useMeshCache = true;
+            i++; // Skip next argument
+        }
+        else if (arg == "-nocache")
+        {
+            config.useMeshCache = false;
+        }
+        else if (arg == "-noshadercache")
+        {
+            config.useShaderCache = false;
+        }
+        else if (arg == "-nowatch")
+        {
+            config.watchShaders = false;
+        }
+        else if (arg == "-stream" && i + 1 < argc)
+        {
+            long long megabytes = 0;
+            if (!parseCount(argv[i + 1], 1, 1 << 20, megabytes))
+            {
+                std::cerr << "Invalid streaming memory budget: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.streamMeshLoading = true;
+            config.streamMemoryBudget = static_cast<size_t>(megabytes) * 1024 * 1024;
+            i++; // Skip next argument
+        }
+        else if (arg == "-sync")
+        {
+            config.asyncMeshLoading = false;
+        }
+        else if (arg == "-upload" && i + 1 < argc)
+        {
+            long long kilobytes = 0;
+            if (!parseCount(argv[i + 1], 4, 1 << 20, kilobytes))
+            {
+                std::cerr << "Invalid upload budget: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.uploadBudgetBytes = static_cast<size_t>(kilobytes) * 1024;
+            i++; // Skip next argument
+        }
+        else if (arg == "-lod" && i + 1 < argc)
+        {
+            // Comma separated triangle ratios, e.g. "0.5,0.25,0.1"
+            std::stringstream ratios(argv[i + 1]);
+            std::string ratio;
+            config.lodRatios.clear();
+            while (std::getline(ratios, ratio, ','))
+            {
+                double value = 0.0;
+                if (!parseNumber(ratio.c_str(), 0.0, 1.0, value) || value <= 0.0 || value >= 1.0)
+                {
+                    std::cerr << "Invalid LOD ratio: " << ratio << std::endl;
+                    return false;
+                }
+                config.lodRatios.push_back(static_cast<float>(value));
+            }
+            i++; // Skip next argument
+        }
+        else if (arg == "-lodpx" && i + 1 < argc)
+        {
+            double pixels = 0.0;
+            if (!parseNumber(argv[i + 1], 0.0, std::numeric_limits<float>::max(), pixels) || pixels <= 0.0)
+            {
+                std::cerr << "Invalid LOD pixel error: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.lodPixelError = static_cast<float>(pixels);
+            i++; // Skip next argument
+        }
+        else if (arg == "-meshlets")
+        {
+            config.buildMeshlets = true;
+        }
+        else if (arg == "-tickrate" && i + 1 < argc)
+        {
+            double rate = 0.0;
+            if (!parseNumber(argv[i + 1], 0.001, 1e6, rate))
+            {
+                std::cerr << "Invalid tick rate: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.tickRate = rate;
+            i++; // Skip next argument
+        }
+        else if (arg == "-playback" && i + 1 < argc)
+        {
+            double rate = 0.0;
+            if (!parseNumber(argv[i + 1], 0.0, std::numeric_limits<float>::max(), rate) || rate <= 0.0)
+            {
+                std::cerr << "Invalid playback rate: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.playbackRate = static_cast<float>(rate);
+            i++; // Skip next argument
+        }
+        else if (arg == "-pacing" && i + 1 < argc)
+        {
+            std::string pacing = argv[i + 1];
+            if (pacing == "vsync")
+            {
+                config.pacingMode = PacingMode::VSync;
+            }
+            else if (pacing == "adaptive")
+            {
+                config.pacingMode = PacingMode::Adaptive;
+            }
+            else if (pacing == "uncapped")
+            {
+                config.pacingMode = PacingMode::Uncapped;
+            }
+            else
+            {
+                std::cerr << "Invalid pacing mode: " << pacing << std::endl;
+                return false;
+            }
+            i++; // Skip next argument
+        }
+        else if (arg == "-fpscap" && i + 1 < argc)
+        {
+            double rate = 0.0;
+            if (!parseNumber(argv[i + 1], 0.001, 1e6, rate))
+            {
+                std::cerr << "Invalid frame rate cap: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.frameRateCap = rate;
+            config.pacingMode = PacingMode::Capped;
+            i++; // Skip next argument
+        }
+        else if (arg == "-framereport" && i + 1 < argc)
+        {
+            double seconds = 0.0;
+            if (!parseNumber(argv[i + 1], 0.0, 86400.0, seconds))
+            {
+                std::cerr << "Invalid frame report interval: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.frameReportInterval = static_cast<float>(seconds);
+            i++; // Skip next argument
+        }
+        else if (arg == "-loglevel" && i + 1 < argc)
+        {
+            if (!Logger::parseLevel(argv[i + 1], config.logLevel))
+            {
+                std::cerr << "Invalid log level: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            i++; // Skip next argument
+        }
+        else if (arg == "-hud")
+        {
+            config.showHud = true;
+        }
+        else if (arg == "-trace" && i + 1 < argc)
+        {
+            config.tracePath = argv[i + 1];
+            i++; // Skip next argument
+        }
+        else if ((arg == "--headless" || arg == "-headless") && i + 1 < argc)
+        {
+            // Framebuffer size as WxH, e.g. 1920x1080
+            std::string size = argv[i + 1];
+            size_t separator = size.find('x');
+            long long width = 0;
+            long long height = 0;
+            if (separator == std::string::npos ||
+                !parseCount(size.substr(0, separator).c_str(), 1, std::numeric_limits<int>::max(), width) ||
+                !parseCount(size.substr(separator + 1).c_str(), 1, std::numeric_limits<int>::max(), height))
+            {
+                std::cerr << "Invalid headless size: " << size << std::endl;
+                return false;
+            }
+            config.headlessWidth = static_cast<int>(width);
+            config.headlessHeight = static_cast<int>(height);
+            config.headless = true;
+            i++; // Skip next argument
+        }
+        else if (arg == "-frames" && i + 1 < argc)
+        {
+            long long frames = 0;
+            if (!parseCount(argv[i + 1], 1, std::numeric_limits<int>::max(), frames))
+            {
+                std::cerr << "Invalid frame count: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.headlessFrames = static_cast<size_t>(frames);
+            i++; // Skip next argument
+        }
+        else if ((arg == "--bench" || arg == "-bench") && i + 1 < argc)
+        {
+            long long frames = 0;
+            if (!parseCount(argv[i + 1], 1, std::numeric_limits<int>::max(), frames))
+            {
+                std::cerr << "Invalid benchmark frame count: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.benchmarkFrames = static_cast<size_t>(frames);
+            i++; // Skip next argument
+        }
+        else if (arg == "-benchout" && i + 1 < argc)
+        {
+            config.benchmarkOutput = argv[i + 1];
+            i++; // Skip next argument
+        }
+        else if (arg == "-baseline" && i + 1 < argc)
+        {
+            config.benchmarkBaseline = argv[i + 1];
+            i++; // Skip next argument
+        }
+        else if (arg == "-threshold" && i + 1 < argc)
+        {
+            double percent = 0.0;
+            if (!parseNumber(argv[i + 1], 0.0, 1e6, percent))
+            {
+                std::cerr << "Invalid regression threshold: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.benchmarkThreshold = percent / 100.0;
+            i++; // Skip next argument
+        }
+        else if (arg == "-export" && i + 1 < argc)
+        {
+            config.exportOptions.directory = argv[i + 1];
+            config.exportFrames = true;
+            i++; // Skip next argument
+        }
+        else if (arg == "-exportfmt" && i + 1 < argc)
+        {
+            std::string format = argv[i + 1];
+            if (format == "png")
+            {
+                config.exportOptions.format = ExportFormat::PNG;
+            }
+            else if (format == "ppm")
+            {
+                config.exportOptions.format = ExportFormat::PPM;
+            }
+            else if (format == "raw")
+            {
+                config.exportOptions.format = ExportFormat::Raw;
+            }
+            else
+            {
+                std::cerr << "Invalid export format: " << format << std::endl;
+                return false;
+            }
+            i++; // Skip next argument
+        }
+        else if (arg == "-exportpipe" && i + 1 < argc)
+        {
+            config.exportOptions.pipeCommand = argv[i + 1];
+            config.exportFrames = true;
+            i++; // Skip next argument
+        }
+        else if (arg == "-exportfps" && i + 1 < argc)
+        {
+            double fps = 0.0;
+            if (!parseNumber(argv[i + 1], 0.0, 10000.0, fps) || fps <= 0.0)
+            {
+                std::cerr << "Invalid export frame rate: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.exportFps = fps;
+            i++; // Skip next argument
+        }
+        else if (arg == "-exportring" && i + 1 < argc)
+        {
+            long long buffers = 0;
+            if (!parseCount(argv[i + 1], 1, 64, buffers))
+            {
+                std::cerr << "Invalid export ring size: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.exportOptions.framesInFlight = static_cast<int>(buffers);
+            i++; // Skip next argument
+        }
+        else if (arg == "-n" && i + 1 < argc)
+        {
+            long long instances = 0;
+            if (!parseCount(argv[i + 1], 1, 10000000, instances))
+            {
+                std::cerr << "Invalid instance count: " << argv[i + 1] << std::endl;
+                return false;
+            }
+            config.instanceCount = static_cast<size_t>(instances);
+            i++; // Skip next argument
+        }
+        else if (arg == "-benchinst")
+        {
+            config.benchmarkInstances = true;
+        }
+        else if (arg == "-benchvs")
+        {
+            config.benchmarkVertexShader = true;
+        }
         else if (arg == "-h" || arg == "--help")
         {
             config.showHelp = true;
@@ -192,6 +737,41 @@ void printHelp(const char *programName)
     std::cout << "  -it <type>     Interpolation type: crspline/catmullrom/0 (default), bspline/1" << std::endl;
     std::cout << "  -kf <keyframes> Keyframes, format: \"x,y,z:e1,e2,e3;...\" (Euler angles in degrees)" << std::endl;
     std::cout << "  -m <filepath>   File path, loads models with .obj extension (default: cube or teapot.obj if it exists)" << std::endl;
+    std::cout << "  -vf <format>    GPU vertex format: float/0 (default, 32 bytes), compact/1 (16 bytes)" << std::endl;
+    std::cout << "  -cache <dir>    Directory for processed mesh and shader cache files (default: .kfcache)" << std::endl;
+    std::cout << "  -nocache        Always parse the model file, never read or write the mesh cache" << std::endl;
+    std::cout << "  -noshadercache  Always compile shaders, never read or write linked program binaries" << std::endl;
+    std::cout << "  -nowatch        Do not reload shaders when their files change" << std::endl;
+    std::cout << "  -stream <MB>    Bounded-memory streaming OBJ ingestion with the given memory budget" << std::endl;
+    std::cout << "  -sync           Load the model before the first frame instead of in the background" << std::endl;
+    std::cout << "  -upload <KB>    Per-frame GPU upload budget for background loading (default: 4096)" << std::endl;
+    std::cout << "  -lod <ratios>   Generate simplified LODs at these triangle ratios, e.g. 0.5,0.25,0.1" << std::endl;
+    std::cout << "  -lodpx <px>     Largest on-screen LOD error in pixels (default: 1)" << std::endl;
+    std::cout << "  -meshlets       Split the model into meshlets and cull them against the view each frame" << std::endl;
+    std::cout << "  -tickrate <hz>  Animation evaluations per second, frames interpolate between them (default: 60)" << std::endl;
+    std::cout << "  -playback <x>   Animation playback speed, animation seconds per second (default: 0.5)" << std::endl;
+    std::cout << "  -pacing <mode>  Frame pacing: vsync, adaptive (late frames tear) or uncapped (default: vsync)" << std::endl;
+    std::cout << "  -fpscap <hz>    Swap without vsync and sleep to hold this frame rate" << std::endl;
+    std::cout << "  -framereport <s> Print frame time percentiles and hitches every s seconds" << std::endl;
+    std::cout << "  -trace <file>    Write PROFILE_SCOPE timings as a Chrome trace at exit (T writes one anytime)"
+              << std::endl;
+    std::cout << "  -hud            Show the performance HUD from the start (H toggles it)" << std::endl;
+    std::cout << "  -loglevel <l>   Least severe messages printed: debug, info, warning or error (default: info)"
+              << std::endl;
+    std::cout << "  --headless <WxH> Render offscreen through EGL at this size, no window or display needed" << std::endl;
+    std::cout << "  -frames <n>     Frames to render in headless mode (default: 300)" << std::endl;
+    std::cout << "  --bench <frames> Scripted benchmark of every orientation/interpolation mode, JSON results, then exit" << std::endl;
+    std::cout << "  -benchout <file> Benchmark results file (default: bench_results.json)" << std::endl;
+    std::cout << "  -baseline <file> Compare benchmark results with a baseline, fail on regressions" << std::endl;
+    std::cout << "  -threshold <%>  Slowdown against the baseline counted as a regression (default: 10)" << std::endl;
+    std::cout << "  -export <dir>   Render the whole animation to image files in dir, then exit" << std::endl;
+    std::cout << "  -exportfmt <f>  Export image format: png, ppm or raw RGB (default: png)" << std::endl;
+    std::cout << "  -exportpipe <cmd> Send raw RGB frames to this command's stdin instead, e.g. an encoder" << std::endl;
+    std::cout << "  -exportfps <fps> Export frame rate in animation time (default: 30)" << std::endl;
+    std::cout << "  -exportring <n> Frames read back asynchronously at once (default: 3)" << std::endl;
+    std::cout << "  -n <count>      Draw this many animated copies of the model with one instanced draw" << std::endl;
+    std::cout << "  -benchinst      Benchmark 1 to 100000 instances, per-object vs instanced draws, then exit" << std::endl;
+    std::cout << "  -benchvs        Benchmark per-vertex vs CPU normal matrices on the model, then exit" << std::endl;
     std::cout << "  -h, --help     Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
@@ -0,0 +1,37 @@
+#include "motion/VertexLayout.h"
+#include <glm/gtc/packing.hpp>
+
+size_t vertexStride(VertexFormat format)
+{
+    return format == VertexFormat::Compact ? sizeof(CompactVertex) : 8 * sizeof(float);
+}
+
+glm::vec3 quantizationScale(const glm::vec3 &minBounds, const glm::vec3 &maxBounds)
+{
+    // Degenerate axes keep a unit scale so the quantized value stays at the offset
+    glm::vec3 scale = maxBounds - minBounds;
+    for (int i = 0; i < 3; i++)
+    {
+        if (scale[i] <= 0.0f)
+            scale[i] = 1.0f;
+    }
+    return scale;
+}
+
+void packCompactVertex(const float *src, const glm::vec3 &offset, const glm::vec3 &scale, CompactVertex &dst)
+{
+    glm::vec3 p = (glm::vec3(src[0], src[1], src[2]) - offset) / scale;
+    p = glm::clamp(p, 0.0f, 1.0f);
+    dst.position[0] = glm::packUnorm1x16(p.x);
+    dst.position[1] = glm::packUnorm1x16(p.y);
+    dst.position[2] = glm::packUnorm1x16(p.z);
+    dst.position[3] = 0;
+
+    glm::vec3 n(src[3], src[4], src[5]);
+    float len = glm::length(n);
+    n = len > 0.0f ? n / len : glm::vec3(0.0f, 0.0f, 1.0f);
+    dst.normal = glm::packSnorm3x10_1x2(glm::vec4(n, 0.0f));
+
+    dst.texcoord[0] = glm::packHalf1x16(src[6]);
+    dst.texcoord[1] = glm::packHalf1x16(src[7]);
+}
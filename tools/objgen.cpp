@@ -0,0 +1,210 @@
+// Writes synthetic OBJ files of any size for loader benchmarks. The surface is
+// a torus grid, so every face is non-degenerate and the output is the same
+// for the same arguments.
+//
+//   objgen <triangles> <output.obj> [--corners v|vt|vn|vtvn] [--faces tri|quad|ngon] [--sides N]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+const double PI = 3.14159265358979323846;
+const double MAJOR_RADIUS = 1.0;
+const double MINOR_RADIUS = 0.35;
+
+struct Options
+{
+    size_t triangles = 0;
+    std::string path;
+    bool uvs = false;
+    bool normals = false;
+    std::string faces = "tri";
+    int sides = 6; // Polygon size for ngon faces: 2k + 2 corners spanning k grid quads
+};
+
+void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " <triangles> <output.obj> [options]\n"
+              << "  --corners <fmt>  Face corner format: v, vt (v/vt), vn (v//vn), vtvn (v/vt/vn)\n"
+              << "                   Default: v\n"
+              << "  --faces <type>   tri, quad or ngon. Default: tri\n"
+              << "  --sides <n>      Corners per ngon face, even and at least 6. Default: 6" << std::endl;
+}
+
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+    if (argc < 3)
+        return false;
+
+    char *end = nullptr;
+    options.triangles = std::strtoull(argv[1], &end, 10);
+    if (end == argv[1] || *end != '\0' || argv[1][0] == '-' || options.triangles == 0)
+    {
+        std::cerr << "Invalid triangle count: " << argv[1] << std::endl;
+        return false;
+    }
+    options.path = argv[2];
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--corners")
+        {
+            if (value != "v" && value != "vt" && value != "vn" && value != "vtvn")
+                return false;
+            options.uvs = value == "vt" || value == "vtvn";
+            options.normals = value == "vn" || value == "vtvn";
+        }
+        else if (arg == "--faces")
+        {
+            if (value != "tri" && value != "quad" && value != "ngon")
+                return false;
+            options.faces = value;
+        }
+        else if (arg == "--sides")
+        {
+            long sides = std::strtol(value.c_str(), &end, 10);
+            if (*end != '\0' || sides < 6 || sides > 1000000 || sides % 2 != 0)
+            {
+                std::cerr << "Invalid ngon side count: " << value << std::endl;
+                return false;
+            }
+            options.sides = static_cast<int>(sides);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options.triangles > 0 && (argc - 3) % 2 == 0;
+}
+
+void writeCorner(FILE *file, size_t vertex, const Options &options)
+{
+    // OBJ indices are 1-based; positions, uvs and normals share the grid numbering
+    size_t index = vertex + 1;
+    if (options.uvs && options.normals)
+        std::fprintf(file, " %zu/%zu/%zu", index, index, index);
+    else if (options.uvs)
+        std::fprintf(file, " %zu/%zu", index, index);
+    else if (options.normals)
+        std::fprintf(file, " %zu//%zu", index, index);
+    else
+        std::fprintf(file, " %zu", index);
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Grid quads per face and triangles per face
+    size_t quadsPerFace = options.faces == "ngon" ? (options.sides - 2) / 2 : 1;
+    size_t trianglesPerFace = options.faces == "tri" ? 1 : 2 * quadsPerFace;
+    size_t faceCount = (options.triangles + trianglesPerFace - 1) / trianglesPerFace;
+    size_t quadCount = options.faces == "tri" ? (options.triangles + 1) / 2 : faceCount * quadsPerFace;
+
+    // Columns run around the major ring in whole faces; rows wrap around the tube
+    size_t columns = std::max<size_t>(3, static_cast<size_t>(std::sqrt(2.0 * quadCount)));
+    columns = (columns + quadsPerFace - 1) / quadsPerFace * quadsPerFace;
+    size_t rows = std::max<size_t>(3, (quadCount + columns - 1) / columns);
+
+    FILE *file = std::fopen(options.path.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "Cannot write " << options.path << std::endl;
+        return 1;
+    }
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    std::fprintf(file, "# objgen: %zu triangles, %s faces\n", options.triangles, options.faces.c_str());
+    for (size_t row = 0; row < rows; row++)
+    {
+        double v = 2.0 * PI * row / rows;
+        for (size_t column = 0; column < columns; column++)
+        {
+            double u = 2.0 * PI * column / columns;
+            double ring = MAJOR_RADIUS + MINOR_RADIUS * std::cos(v);
+            std::fprintf(file, "v %.6f %.6f %.6f\n", ring * std::cos(u), MINOR_RADIUS * std::sin(v),
+                         ring * std::sin(u));
+        }
+    }
+    if (options.uvs)
+    {
+        for (size_t row = 0; row < rows; row++)
+        {
+            for (size_t column = 0; column < columns; column++)
+                std::fprintf(file, "vt %.6f %.6f\n", static_cast<double>(column) / columns,
+                             static_cast<double>(row) / rows);
+        }
+    }
+    if (options.normals)
+    {
+        for (size_t row = 0; row < rows; row++)
+        {
+            double v = 2.0 * PI * row / rows;
+            for (size_t column = 0; column < columns; column++)
+            {
+                double u = 2.0 * PI * column / columns;
+                std::fprintf(file, "vn %.6f %.6f %.6f\n", std::cos(v) * std::cos(u), std::sin(v),
+                             std::cos(v) * std::sin(u));
+            }
+        }
+    }
+
+    // Faces in row order until the requested count is reached
+    auto vertexAt = [columns, rows](size_t row, size_t column) { return (row % rows) * columns + column % columns; };
+    size_t written = 0;
+    for (size_t row = 0; row < rows && written < options.triangles; row++)
+    {
+        for (size_t column = 0; column < columns && written < options.triangles; column += quadsPerFace)
+        {
+            size_t a = vertexAt(row, column), b = vertexAt(row, column + quadsPerFace);
+            size_t c = vertexAt(row + 1, column + quadsPerFace), d = vertexAt(row + 1, column);
+            if (options.faces == "tri")
+            {
+                size_t tri[2][3] = {{a, b, c}, {a, c, d}};
+                for (int t = 0; t < 2 && written < options.triangles; t++, written++)
+                {
+                    std::fputc('f', file);
+                    for (size_t corner : tri[t])
+                        writeCorner(file, corner, options);
+                    std::fputc('\n', file);
+                }
+                continue;
+            }
+
+            // Along the bottom edge, then back along the top
+            std::fputc('f', file);
+            for (size_t i = 0; i <= quadsPerFace; i++)
+                writeCorner(file, vertexAt(row, column + i), options);
+            for (size_t i = quadsPerFace + 1; i-- > 0;)
+                writeCorner(file, vertexAt(row + 1, column + i), options);
+            std::fputc('\n', file);
+            written += trianglesPerFace;
+        }
+    }
+
+    bool ok = std::ferror(file) == 0;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+    {
+        std::cerr << "Cannot write " << options.path << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << options.path << ": " << rows * columns << " vertices, " << written << " triangles"
+              << std::endl;
+    return 0;
+}